@@ -0,0 +1,814 @@
+/**
+Benchmark of the whole pipeline (SGL_RenderFrame) on generated scenes, rendered offscreen so it runs headless.
+Every scene is built with several amounts of triangles and rendered at several resolutions, the results are
+printed as JSON (triangles per second, frame times and time spent in every stage) to compare builds.
+Scenes:
+    single_mesh  One grid mesh, tilted so depth varies across it
+    many_meshes  One cube mesh per 12 triangles covering most of the image, half of the triangles are culled
+    near_clip    Long triangles going from behind the camera to in front of it, all of them are clipped by the near plane
+Usage: sgl_bench [--scenes a,b] [--triangles 1,1000,...] [--resolutions 320x240,...] [--frames max] [--seconds budget]
+                 [--tile-size size] [--threads count] [--simd scalar|sse2|avx2] (see SGL_RendererSetTileSize,
+                 SGL_RendererSetThreadCount and SGL_RendererSetRasterPath, also used by --check)
+
+Golden image check: renders a fixed set of small cases of the scenes once and compares the color and depth buffers
+with the references of a directory (hashes in golden.txt, color images as PPM). Run it before landing changes
+to the rasterizer, optimized paths must give the same images.
+    sgl_bench --check DIR [--tolerance delta] [--max-diff-pixels count] [--out DIR]
+        Every case is rendered with each raster path the CPU supports (scalar, SSE2, AVX2), with 16 pixels tiles on
+        4 threads and without tiles. --simd, --tile-size or --threads render it once with those options instead.
+        Exit code 1 if a case differs. By default color and depth must be identical, with a tolerance a case passes
+        when at most count pixels have a channel differing by more than delta (depth is then only reported).
+        The image and a diff (differing pixels in red) of failing cases are written in --out (default .).
+    sgl_bench --update DIR
+        Writes the references of the current build, only after checking the differences are expected.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SGL.h"
+
+#define MAX_ITEMS 16
+#define MAX_PATH_SIZE 512
+#define MAX_NAME_SIZE 64 // Name of a golden case
+#define GOLDEN_MANIFEST "golden.txt"
+
+static const int MIN_FRAMES = 5; // Frames rendered even when a frame is longer than the time budget
+
+// Cases of the golden image check, small so the references stay small. 113x71 isn't a multiple of any tile or
+// SIMD width so the edges of optimized paths are covered.
+static const float_safe_index_t golden_triangles[] = {100, 5000};
+static const int golden_widths[] = {160, 113};
+static const int golden_heights[] = {120, 71};
+
+typedef SGL_Scene* (*scene_builder)(float_safe_index_t triangles);
+
+typedef struct {
+    const char *name;
+    scene_builder build;
+} scene_type;
+
+typedef struct {
+    const char *scenes[MAX_ITEMS];
+    int scenes_count;
+    float_safe_index_t triangles[MAX_ITEMS];
+    int triangles_count;
+    int widths[MAX_ITEMS];
+    int heights[MAX_ITEMS];
+    int resolutions_count;
+    int max_frames;
+    double seconds;
+    const char *golden_dir; // Golden image check when not NULL
+    bool update_golden;
+    int tolerance;
+    int max_diff_pixels;
+    const char *out_dir;
+    int tile_size; // -1 keeps the renderer's default
+    int threads_count; // -1 keeps the renderer's default
+    int raster_path; // SGL_RasterPath, -1 keeps the renderer's default (every path with --check)
+} options;
+
+typedef struct {
+    const char *name;
+    SGL_RasterPath path;
+} raster_path_name;
+
+static const raster_path_name raster_paths[] = {
+    {"scalar", SGL_RASTER_SCALAR},
+    {"sse2", SGL_RASTER_SSE2},
+    {"avx2", SGL_RASTER_AVX2}
+};
+
+// Ways every golden case is rendered, checked against the same references. -1 keeps the renderer's default.
+typedef struct {
+    const char *name;
+    int raster_path;
+    int tile_size;
+    int threads_count;
+} golden_variant;
+
+static const golden_variant golden_variants[] = {
+    {"scalar", SGL_RASTER_SCALAR, -1, -1},
+    {"sse2", SGL_RASTER_SSE2, -1, -1},
+    {"avx2", SGL_RASTER_AVX2, -1, -1},
+    {"tiles16_threads4", -1, 16, 4}, // Many small tiles shared by several workers
+    {"untiled", -1, 0, -1}
+};
+
+// Used instead of golden_variants for --update and when the options pick the path, tile size or threads
+static const golden_variant options_variant = {"options", -1, -1, -1};
+
+static uint32_t random_state = 1;
+
+// Small LCG so the scenes are the same on every platform
+static float random_float(float min, float max) {
+    random_state = random_state * 1664525u + 1013904223u;
+    return min + (max - min) * (float)(random_state >> 8) / (float)(1u << 24);
+}
+
+static uint32_t random_color(void) {
+    return SGL_PackColor((SGL_Color){random_float(0.2f, 1.0f), random_float(0.2f, 1.0f), random_float(0.2f, 1.0f)});
+}
+
+static SGL_Scene* build_single_mesh(float_safe_index_t triangles) {
+    SGL_Scene *scene = SGL_CreateScene();
+
+    // Square grid of quads (2 triangles each), the last quad is cut in half when triangles is odd
+    float_safe_index_t quads = (triangles + 1) / 2;
+    float_safe_index_t side = 1;
+    while ((size_t)side * side < quads) side++;
+
+    float_safe_index_t vertices_count = (side + 1) * (side + 1);
+    float *positions = malloc(sizeof(float) * 3 * vertices_count);
+    float_safe_index_t *indices = malloc(sizeof(float_safe_index_t) * 3 * triangles);
+    uint32_t *colors = malloc(sizeof(uint32_t) * triangles);
+
+    for (float_safe_index_t y = 0; y <= side; y++)
+    {
+        for (float_safe_index_t x = 0; x <= side; x++)
+        {
+            float *position = &positions[(y * (side + 1) + x) * 3];
+            position[0] = (float)x / side * 2.0f - 1.0f;
+            position[1] = (float)y / side * 2.0f - 1.0f;
+            position[2] = 0.0f;
+        }
+    }
+
+    for (float_safe_index_t i = 0; i < triangles; i++)
+    {
+        float_safe_index_t quad = i / 2;
+        float_safe_index_t top_left = (quad / side) * (side + 1) + quad % side;
+        float_safe_index_t top_right = top_left + 1;
+        float_safe_index_t bottom_left = top_left + side + 1;
+        float_safe_index_t bottom_right = bottom_left + 1;
+        float_safe_index_t *triangle = &indices[i * 3];
+
+        if (i % 2 == 0) {
+            triangle[0] = top_left;
+            triangle[1] = bottom_left;
+            triangle[2] = top_right;
+        } else {
+            triangle[0] = top_right;
+            triangle[1] = bottom_left;
+            triangle[2] = bottom_right;
+        }
+
+        colors[i] = random_color();
+    }
+
+    SGL_Mesh *mesh = SGL_CreateIndexedMesh(positions, vertices_count, indices, triangles, colors, (SGL_Vector3){0.0f, 0.0f, 4.0f}, (SGL_Vector3){30.0f, 20.0f, 0.0f}, (SGL_Vector3){3.0f, 3.0f, 3.0f});
+    SGL_ListAdd(scene->meshes, mesh);
+
+    free(positions);
+    free(indices);
+    free(colors);
+
+    return scene;
+}
+
+static SGL_Scene* build_many_meshes(float_safe_index_t triangles) {
+    SGL_Scene *scene = SGL_CreateScene();
+    float_safe_index_t cubes = (triangles + 11) / 12;
+
+    // Sized so the cubes cover most of the image whatever their amount, overlapping a lot (depth test, tiles and
+    // blocks are all exercised even by the small golden cases)
+    float scale = SDL_min(2.5f, sqrtf(60.0f / cubes));
+
+    // Cubes spread in a slab filling the view, a bit wider so some of them are clipped by the sides. Random
+    // orientations show 1 to 3 faces of each
+    for (float_safe_index_t i = 0; i < cubes; i++)
+    {
+        SGL_Mesh *cube = SGL_CreateCubeMesh((SGL_Vector3){random_float(-8.0f, 8.0f), random_float(-6.0f, 6.0f), random_float(6.0f, 10.0f)});
+        SGL_MeshSetOrientation(cube, (SGL_Vector3){random_float(0.0f, 360.0f), random_float(0.0f, 360.0f), 0.0f});
+        SGL_MeshSetScale(cube, (SGL_Vector3){scale, scale, scale});
+        SGL_ListAdd(scene->meshes, cube);
+    }
+
+    return scene;
+}
+
+static SGL_Scene* build_near_clip(float_safe_index_t triangles) {
+    SGL_Scene *scene = SGL_CreateScene();
+
+    float *positions = malloc(sizeof(float) * 9 * triangles);
+    float_safe_index_t *indices = malloc(sizeof(float_safe_index_t) * 3 * triangles);
+    uint32_t *colors = malloc(sizeof(uint32_t) * triangles);
+
+    // One vertex behind the camera and two in front: every triangle crosses the near plane and is split in two.
+    // They are long slivers pointing at the camera so they stay small on screen after clipping.
+    for (float_safe_index_t i = 0; i < triangles; i++)
+    {
+        float dx = random_float(-0.9f, 0.9f);
+        float dy = random_float(-0.7f, 0.7f);
+        float far = random_float(3.0f, 8.0f);
+        float *triangle = &positions[i * 9];
+
+        triangle[0] = -dx * 0.5f;
+        triangle[1] = -dy * 0.5f + 0.002f;
+        triangle[2] = -0.5f;
+
+        triangle[3] = dx * far;
+        triangle[4] = dy * far;
+        triangle[5] = far;
+
+        triangle[6] = dx * far + 0.03f;
+        triangle[7] = dy * far;
+        triangle[8] = far;
+
+        // Wound to face the camera
+        indices[i * 3] = i * 3;
+        indices[i * 3 + 1] = i * 3 + 2;
+        indices[i * 3 + 2] = i * 3 + 1;
+        colors[i] = random_color();
+    }
+
+    SGL_Mesh *mesh = SGL_CreateIndexedMesh(positions, triangles * 3, indices, triangles, colors, (SGL_Vector3){0.0f, 0.0f, 0.0f}, (SGL_Vector3){0.0f, 0.0f, 0.0f}, (SGL_Vector3){1.0f, 1.0f, 1.0f});
+    SGL_ListAdd(scene->meshes, mesh);
+
+    free(positions);
+    free(indices);
+    free(colors);
+
+    return scene;
+}
+
+static const scene_type scene_types[] = {
+    {"single_mesh", build_single_mesh},
+    {"many_meshes", build_many_meshes},
+    {"near_clip", build_near_clip}
+};
+
+static void free_scene(SGL_Scene *scene) {
+    for (float_safe_index_t i = 0; i < scene->meshes->size; i++)
+    {
+        SGL_FreeMesh(scene->meshes->items[i]);
+    }
+
+    SGL_FreeScene(scene);
+}
+
+static int compare_ns(const void *a, const void *b) {
+    Uint64 x = *(const Uint64*)a;
+    Uint64 y = *(const Uint64*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank percentile of sorted frame times
+static double percentile_ms(const Uint64 *sorted_ns, int count, double percentile) {
+    int rank = (int)(percentile / 100.0 * count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted_ns[rank - 1] / 1e6;
+}
+
+static SGL_Renderer* create_renderer(int width, int height, SGL_Scene *scene, const options *opts) {
+    SGL_Renderer *renderer = SGL_CreateOffscreenRenderer(width, height, scene);
+
+    if (renderer && opts->tile_size >= 0) {
+        SGL_RendererSetTileSize(renderer, opts->tile_size);
+    }
+
+    if (renderer && opts->threads_count >= 0) {
+        SGL_RendererSetThreadCount(renderer, opts->threads_count);
+    }
+
+    if (renderer && opts->raster_path >= 0 && !SGL_RendererSetRasterPath(renderer, (SGL_RasterPath)opts->raster_path)) {
+        fprintf(stderr, "Raster path not supported by this build or CPU\n");
+        SGL_FreeRenderer(renderer);
+        return NULL;
+    }
+
+    return renderer;
+}
+
+/**
+ * Renders a case for the time budget and prints its results as a JSON object.
+ * \param first false to print the comma separating it from the previous case
+ * \returns false if the renderer couldn't be created, nothing is printed
+ */
+static bool run_case(const char *scene_name, SGL_Scene *scene, float_safe_index_t triangles, int width, int height, const options *opts, bool first) {
+    SGL_Renderer *renderer = create_renderer(width, height, scene, opts);
+    if (!renderer) {
+        return false;
+    }
+
+    Uint64 *frame_ns = malloc(sizeof(Uint64) * opts->max_frames);
+    Uint64 stage_ns[SGL_STAGE_COUNT] = {0};
+    Uint64 total_ns = 0;
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    SGL_FrameStats stats = {0};
+    bool has_stats = false;
+    int frames = 0;
+
+    // Warm up: first frame grows the frame arena and the caches of the meshes
+    SGL_RenderFrame(renderer);
+
+    while (frames < opts->max_frames && (frames < MIN_FRAMES || total_ns < opts->seconds * 1e9))
+    {
+        SGL_RendererRequestRedraw(renderer);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        SGL_RenderFrame(renderer);
+        Uint64 end = SDL_GetPerformanceCounter();
+
+        frame_ns[frames] = (end - start) * SDL_NS_PER_SECOND / frequency;
+        total_ns += frame_ns[frames];
+        frames++;
+
+        has_stats = SGL_RendererGetFrameStats(renderer, &stats);
+        for (int i = 0; i < SGL_STAGE_COUNT && has_stats; i++)
+        {
+            stage_ns[i] += stats.stage_ns[i];
+        }
+    }
+
+    qsort(frame_ns, frames, sizeof(Uint64), compare_ns);
+
+    double mean_seconds = total_ns / 1e9 / frames;
+
+    printf("%s    {\"scene\": \"%s\", \"triangles\": %" PRIu32 ", \"meshes\": %" PRIu32 ", \"width\": %d, \"height\": %d, \"frames\": %d,\n",
+        first ? "" : ",\n", scene_name, triangles, scene->meshes->size, width, height, frames);
+    printf("     \"triangles_per_second\": %.0f,\n", triangles / mean_seconds);
+    printf("     \"frame_ms\": {\"mean\": %.4f, \"median\": %.4f, \"p99\": %.4f, \"min\": %.4f, \"max\": %.4f}",
+        mean_seconds * 1e3, percentile_ms(frame_ns, frames, 50.0), percentile_ms(frame_ns, frames, 99.0), frame_ns[0] / 1e6, frame_ns[frames - 1] / 1e6);
+
+    // Not available when SGL is compiled with SGL_DISABLE_FRAME_STATS
+    if (has_stats) {
+        printf(",\n     \"stage_ms\": {");
+        for (int i = 0; i < SGL_STAGE_COUNT; i++)
+        {
+            printf("%s\"%s\": %.4f", i == 0 ? "" : ", ", SGL_StageName(i), stage_ns[i] / 1e6 / frames);
+        }
+        printf("},\n");
+
+        SGL_PipelineStats *pipeline = &stats.pipeline;
+        Uint64 clipped = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            clipped += pipeline->triangles_clipped[i];
+        }
+
+        printf("     \"pipeline\": {\"triangles_in\": %" PRIu64 ", \"triangles_culled\": %" PRIu64 ", \"triangles_clipped\": %" PRIu64 ", \"triangles_rasterized\": %" PRIu64 ", \"pixels_tested\": %" PRIu64 ", \"pixels_written\": %" PRIu64 "}",
+            pipeline->triangles_in, pipeline->triangles_culled, clipped, pipeline->triangles_rasterized, pipeline->pixels_tested, pipeline->pixels_written);
+    }
+
+    printf("}");
+    fflush(stdout);
+
+    free(frame_ns);
+    SGL_FreeRenderer(renderer);
+    return true;
+}
+
+// Splits a comma separated list, returns the amount of items
+static int split_list(char *list, char **items) {
+    int count = 0;
+
+    for (char *item = strtok(list, ","); item != NULL && count < MAX_ITEMS; item = strtok(NULL, ","))
+    {
+        items[count++] = item;
+    }
+
+    return count;
+}
+
+static const scene_type* find_scene_type(const char *name) {
+    for (size_t i = 0; i < sizeof(scene_types) / sizeof(scene_types[0]); i++)
+    {
+        if (strcmp(scene_types[i].name, name) == 0) {
+            return &scene_types[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool parse_options(int argc, char *argv[], options *opts) {
+    static char default_triangles[] = "1,1000,10000,100000,1000000";
+    static char default_resolutions[] = "320x240,1280x720,1920x1080";
+    char *triangles = default_triangles;
+    char *resolutions = default_resolutions;
+    char *scenes = NULL;
+
+    opts->max_frames = 100;
+    opts->seconds = 1.0;
+    opts->golden_dir = NULL;
+    opts->update_golden = false;
+    opts->tolerance = 0;
+    opts->max_diff_pixels = 0;
+    opts->out_dir = ".";
+    opts->tile_size = -1;
+    opts->threads_count = -1;
+    opts->raster_path = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return false;
+        }
+
+        if (strcmp(argv[i], "--scenes") == 0) {
+            scenes = argv[++i];
+        } else if (strcmp(argv[i], "--triangles") == 0) {
+            triangles = argv[++i];
+        } else if (strcmp(argv[i], "--resolutions") == 0) {
+            resolutions = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0) {
+            opts->max_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            opts->seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--check") == 0 || strcmp(argv[i], "--update") == 0) {
+            opts->update_golden = strcmp(argv[i], "--update") == 0;
+            opts->golden_dir = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0) {
+            opts->tolerance = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-diff-pixels") == 0) {
+            opts->max_diff_pixels = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0) {
+            opts->out_dir = argv[++i];
+        } else if (strcmp(argv[i], "--tile-size") == 0) {
+            opts->tile_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            opts->threads_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--simd") == 0) {
+            const char *name = argv[++i];
+            for (size_t p = 0; p < sizeof(raster_paths) / sizeof(raster_paths[0]); p++)
+            {
+                if (strcmp(raster_paths[p].name, name) == 0) opts->raster_path = raster_paths[p].path;
+            }
+            if (opts->raster_path < 0) {
+                fprintf(stderr, "Unknown raster path %s (expected scalar, sse2 or avx2)\n", name);
+                return false;
+            }
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return false;
+        }
+    }
+
+    if (opts->max_frames < 1) {
+        fprintf(stderr, "--frames must be at least 1\n");
+        return false;
+    }
+
+    char *items[MAX_ITEMS];
+
+    if (scenes != NULL) {
+        opts->scenes_count = split_list(scenes, items);
+        for (int i = 0; i < opts->scenes_count; i++)
+        {
+            if (find_scene_type(items[i]) == NULL) {
+                fprintf(stderr, "Unknown scene %s\n", items[i]);
+                return false;
+            }
+            opts->scenes[i] = items[i];
+        }
+    } else {
+        opts->scenes_count = sizeof(scene_types) / sizeof(scene_types[0]);
+        for (int i = 0; i < opts->scenes_count; i++) opts->scenes[i] = scene_types[i].name;
+    }
+
+    opts->triangles_count = split_list(triangles, items);
+    for (int i = 0; i < opts->triangles_count; i++)
+    {
+        opts->triangles[i] = (float_safe_index_t)strtoul(items[i], NULL, 10);
+        if (opts->triangles[i] == 0) {
+            fprintf(stderr, "Invalid amount of triangles %s\n", items[i]);
+            return false;
+        }
+    }
+
+    opts->resolutions_count = split_list(resolutions, items);
+    for (int i = 0; i < opts->resolutions_count; i++)
+    {
+        if (sscanf(items[i], "%dx%d", &opts->widths[i], &opts->heights[i]) != 2 || opts->widths[i] <= 0 || opts->heights[i] <= 0) {
+            fprintf(stderr, "Invalid resolution %s (expected WIDTHxHEIGHT)\n", items[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// FNV-1a, enough to tell if two buffers are identical
+static Uint64 hash_bytes(const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    Uint64 hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+static bool write_ppm(const char *path, const uint32_t *pixels, int width, int height) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Couldn't write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+    for (int i = 0; i < width * height; i++)
+    {
+        unsigned char rgb[3] = {(pixels[i] >> 16) & 0xFF, (pixels[i] >> 8) & 0xFF, pixels[i] & 0xFF};
+        fwrite(rgb, 1, 3, file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Reads an image written by write_ppm, returns ARGB8888 pixels to free or NULL
+static uint32_t* read_ppm(const char *path, int *width, int *height) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    int max_value;
+    if (fscanf(file, "P6 %d %d %d", width, height, &max_value) != 3 || max_value != 255 || *width <= 0 || *height <= 0 || fgetc(file) == EOF) {
+        fclose(file);
+        return NULL;
+    }
+
+    uint32_t *pixels = malloc(sizeof(uint32_t) * *width * *height);
+
+    for (int i = 0; i < *width * *height; i++)
+    {
+        unsigned char rgb[3];
+        if (fread(rgb, 1, 3, file) != 3) {
+            free(pixels);
+            fclose(file);
+            return NULL;
+        }
+
+        pixels[i] = 0xFF000000u | ((uint32_t)rgb[0] << 16) | ((uint32_t)rgb[1] << 8) | rgb[2];
+    }
+
+    fclose(file);
+    return pixels;
+}
+
+static bool find_golden_hashes(const char *golden_dir, const char *name, Uint64 *color_hash, Uint64 *depth_hash) {
+    char path[MAX_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s", golden_dir, GOLDEN_MANIFEST);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    char line_name[MAX_NAME_SIZE];
+    unsigned long long color, depth;
+    bool found = false;
+
+    while (!found && fscanf(file, "%63s %llx %llx", line_name, &color, &depth) == 3)
+    {
+        if (strcmp(line_name, name) == 0) {
+            *color_hash = color;
+            *depth_hash = depth;
+            found = true;
+        }
+    }
+
+    fclose(file);
+    return found;
+}
+
+static int channel_delta(uint32_t a, uint32_t b) {
+    int delta = 0;
+
+    for (int shift = 0; shift < 24; shift += 8)
+    {
+        int channel_delta = abs((int)((a >> shift) & 0xFF) - (int)((b >> shift) & 0xFF));
+        delta = SDL_max(delta, channel_delta);
+    }
+
+    return delta;
+}
+
+/**
+ * Compares the frame of a case with its reference, prints the result and writes the image and a diff in the output
+ * directory if it fails.
+ * \param variant How the case was rendered (eg: the raster path), added to the printed name and the written files
+ * \returns true if the case passes
+ */
+static bool check_golden_case(const char *name, const char *variant, const uint32_t *pixels, Uint64 color_hash, Uint64 depth_hash, int width, int height, const options *opts) {
+    char label[MAX_NAME_SIZE * 2];
+    snprintf(label, sizeof(label), "%s.%s", name, variant);
+
+    Uint64 golden_color_hash, golden_depth_hash;
+    if (!find_golden_hashes(opts->golden_dir, name, &golden_color_hash, &golden_depth_hash)) {
+        printf("FAIL %s: no reference in %s/%s\n", label, opts->golden_dir, GOLDEN_MANIFEST);
+        return false;
+    }
+
+    bool color_matches = color_hash == golden_color_hash;
+    bool depth_matches = depth_hash == golden_depth_hash;
+
+    if (color_matches && depth_matches) {
+        printf("ok   %s\n", label);
+        return true;
+    }
+
+    char path[MAX_PATH_SIZE];
+    snprintf(path, sizeof(path), "%s/%s.ppm", opts->golden_dir, name);
+
+    int golden_width, golden_height;
+    uint32_t *golden = read_ppm(path, &golden_width, &golden_height);
+    if (golden == NULL || golden_width != width || golden_height != height) {
+        printf("FAIL %s: missing or invalid reference image %s\n", label, path);
+        free(golden);
+        return false;
+    }
+
+    // Differing pixels in red over the darkened reference
+    uint32_t *diff = malloc(sizeof(uint32_t) * width * height);
+    int diff_pixels = 0;
+    int max_delta = 0;
+
+    for (int i = 0; i < width * height; i++)
+    {
+        int delta = channel_delta(pixels[i], golden[i]);
+        max_delta = SDL_max(max_delta, delta);
+
+        if (delta > opts->tolerance) {
+            diff_pixels++;
+            diff[i] = 0xFFFF0000;
+        } else {
+            diff[i] = 0xFF000000 | ((golden[i] >> 2) & 0x3F3F3F);
+        }
+    }
+
+    bool exact = opts->tolerance == 0 && opts->max_diff_pixels == 0;
+    bool passes = !exact && diff_pixels <= opts->max_diff_pixels;
+
+    printf("%s %s: %d pixels differ by more than %d (max delta %d), depth %s\n", passes ? "ok  " : "FAIL", label,
+        diff_pixels, opts->tolerance, max_delta, depth_matches ? "identical" : "differs");
+
+    if (!passes) {
+        snprintf(path, sizeof(path), "%s/%s.actual.ppm", opts->out_dir, label);
+        write_ppm(path, pixels, width, height);
+        snprintf(path, sizeof(path), "%s/%s.diff.ppm", opts->out_dir, label);
+        write_ppm(path, diff, width, height);
+    }
+
+    free(diff);
+    free(golden);
+    return passes;
+}
+
+/**
+ * Renders every golden case once and checks it against the references (or writes them with --update).
+ * \returns Exit code of the program
+ */
+static int run_golden(const options *opts) {
+    FILE *manifest = NULL;
+    char path[MAX_PATH_SIZE];
+    int failures = 0;
+
+    if (opts->update_golden) {
+        snprintf(path, sizeof(path), "%s/%s", opts->golden_dir, GOLDEN_MANIFEST);
+        manifest = fopen(path, "w");
+        if (manifest == NULL) {
+            fprintf(stderr, "Couldn't write %s\n", path);
+            return 1;
+        }
+    }
+
+    for (int s = 0; s < opts->scenes_count; s++)
+    {
+        const scene_type *type = find_scene_type(opts->scenes[s]);
+
+        for (size_t t = 0; t < sizeof(golden_triangles) / sizeof(golden_triangles[0]); t++)
+        {
+            random_state = 1;
+            SGL_Scene *scene = type->build(golden_triangles[t]);
+
+            for (size_t r = 0; r < sizeof(golden_widths) / sizeof(golden_widths[0]); r++)
+            {
+                int width = golden_widths[r];
+                int height = golden_heights[r];
+                char name[MAX_NAME_SIZE];
+                snprintf(name, sizeof(name), "%s_%" PRIu32 "_%dx%d", type->name, golden_triangles[t], width, height);
+
+                // References are written with the default settings, every variant is checked against them
+                bool use_options = opts->update_golden || opts->raster_path >= 0 || opts->tile_size >= 0 || opts->threads_count >= 0;
+                const golden_variant *variants = use_options ? &options_variant : golden_variants;
+                size_t variants_count = use_options ? 1 : sizeof(golden_variants) / sizeof(golden_variants[0]);
+
+                for (size_t v = 0; v < variants_count; v++)
+                {
+                    const golden_variant *variant = &variants[v];
+                    options variant_opts = *opts;
+                    if (!use_options) {
+                        variant_opts.tile_size = variant->tile_size;
+                        variant_opts.threads_count = variant->threads_count;
+                        variant_opts.raster_path = -1; // Set below to tell unsupported paths from failures
+                    }
+
+                    SGL_Renderer *renderer = create_renderer(width, height, scene, &variant_opts);
+                    if (!renderer) {
+                        failures++;
+                        break;
+                    }
+
+                    if (!use_options && variant->raster_path >= 0 && !SGL_RendererSetRasterPath(renderer, (SGL_RasterPath)variant->raster_path)) {
+                        printf("skip %s.%s: not supported by this build or CPU\n", name, variant->name);
+                        SGL_FreeRenderer(renderer);
+                        continue;
+                    }
+
+                    SGL_RenderFrame(renderer);
+
+                    const uint32_t *pixels = SGL_RendererGetPixels(renderer);
+                    const float *depth = SGL_RendererGetDepthBuffer(renderer);
+                    Uint64 color_hash = hash_bytes(pixels, sizeof(uint32_t) * width * height);
+                    Uint64 depth_hash = hash_bytes(depth, sizeof(float) * width * height);
+
+                    if (opts->update_golden) {
+                        snprintf(path, sizeof(path), "%s/%s.ppm", opts->golden_dir, name);
+                        if (write_ppm(path, pixels, width, height)) {
+                            fprintf(manifest, "%s %016" PRIx64 " %016" PRIx64 "\n", name, color_hash, depth_hash);
+                            printf("wrote %s\n", name);
+                        } else {
+                            failures++;
+                        }
+                    } else if (!check_golden_case(name, variant->name, pixels, color_hash, depth_hash, width, height, opts)) {
+                        failures++;
+                    }
+
+                    SGL_FreeRenderer(renderer);
+                }
+            }
+
+            free_scene(scene);
+        }
+    }
+
+    if (manifest != NULL) {
+        fclose(manifest);
+    }
+
+    if (failures > 0) {
+        printf("%d case(s) %s\n", failures, opts->update_golden ? "couldn't be written" : "differ from the references");
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    options opts;
+    if (!parse_options(argc, argv, &opts)) {
+        return 1;
+    }
+
+    if (opts.golden_dir != NULL) {
+        return run_golden(&opts);
+    }
+
+    bool first = true;
+
+    printf("{\n  \"benchmark\": \"sgl_bench\",\n  \"cases\": [\n");
+
+    for (int s = 0; s < opts.scenes_count; s++)
+    {
+        const scene_type *type = find_scene_type(opts.scenes[s]);
+
+        for (int t = 0; t < opts.triangles_count; t++)
+        {
+            // Same scene for every resolution
+            random_state = 1;
+            SGL_Scene *scene = type->build(opts.triangles[t]);
+
+            // Actual amount, many_meshes rounds up to whole cubes
+            float_safe_index_t triangles = 0;
+            for (float_safe_index_t i = 0; i < scene->meshes->size; i++)
+            {
+                triangles += ((SGL_Mesh*)scene->meshes->items[i])->triangles_count;
+            }
+
+            for (int r = 0; r < opts.resolutions_count; r++)
+            {
+                if (run_case(type->name, scene, triangles, opts.widths[r], opts.heights[r], &opts, first)) {
+                    first = false;
+                }
+            }
+
+            free_scene(scene);
+        }
+    }
+
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
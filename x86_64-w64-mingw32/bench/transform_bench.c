@@ -0,0 +1,81 @@
+/**
+Micro-benchmark of the batch vertex transforms (SGL_Transform.h). Transforms the same array of vertices
+many times with each path the CPU supports and prints how many vertices per second each one does.
+Usage: transform_bench [vertices] [iterations]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SGL_Transform.h"
+
+typedef void (*transform_function)(const float m[16], const float *in, float *out, float_safe_index_t count);
+
+static double run(transform_function transform, const float m[16], const float *in, float *out, float_safe_index_t count, int iterations) {
+    // Warm up caches and the branch predictor before timing
+    transform(m, in, out, count);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    for (int i = 0; i < iterations; i++)
+    {
+        transform(m, in, out, count);
+    }
+
+    Uint64 end = SDL_GetPerformanceCounter();
+    double seconds = (double)(end - start) / (double)SDL_GetPerformanceFrequency();
+
+    return ((double)count * iterations) / seconds;
+}
+
+static void report(const char *name, transform_function transform, const float m[16], const float *in, float *out, const float *reference, float_safe_index_t count, int iterations) {
+    double vertices_per_second = run(transform, m, in, out, count, iterations);
+    bool matches = memcmp(out, reference, sizeof(float) * 4 * count) == 0;
+
+    printf("%-7s %10.1f Mvertices/s%s\n", name, vertices_per_second / 1e6, matches ? "" : " (MISMATCH with scalar)");
+}
+
+int main(int argc, char* argv[]) {
+    float_safe_index_t count = argc > 1 ? (float_safe_index_t)strtoul(argv[1], NULL, 10) : 100000;
+    int iterations = argc > 2 ? atoi(argv[2]) : 200;
+
+    float m[16];
+    float *in = malloc(sizeof(float) * 4 * count);
+    float *out = malloc(sizeof(float) * 4 * count);
+    float *reference = malloc(sizeof(float) * 4 * count);
+
+    srand(1);
+    for (int i = 0; i < 16; i++)
+    {
+        m[i] = (float)rand() / RAND_MAX - 0.5f;
+    }
+
+    for (size_t i = 0; i < (size_t)count * 4; i++)
+    {
+        in[i] = ((float)rand() / RAND_MAX - 0.5f) * 100.0f;
+    }
+
+    printf("%" PRIu32 " vertices, %d iterations\n", count, iterations);
+
+    SGL_TransformVerticesScalar(m, in, reference, count);
+    report("scalar", SGL_TransformVerticesScalar, m, in, out, reference, count, iterations);
+
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        report("sse2", SGL_TransformVerticesSSE2, m, in, out, reference, count, iterations);
+    }
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        report("avx2", SGL_TransformVerticesAVX2, m, in, out, reference, count, iterations);
+    }
+#endif
+
+    free(in);
+    free(out);
+    free(reference);
+
+    return 0;
+}
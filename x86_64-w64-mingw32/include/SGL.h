@@ -75,41 +75,54 @@ typedef struct {
 } SGL_Camera;
 
 /**
- * Scene containing all the meshes and the camera.
+ * Scene containing all the meshes, the mesh instances (SGL_MeshInstance) and the camera.
  */
 typedef struct {
     SGL_List *meshes;
+    SGL_List *instances;
     SGL_Camera *currentCamera;
 } SGL_Scene;
 
 SGL_Scene* SGL_CreateScene();
 /**
- * Meshes added in the scene will not be freed. Meshes are managed by the user.
+ * Meshes and instances added in the scene will not be freed. They are managed by the user.
  */
 void SGL_FreeScene(SGL_Scene *scene);
 
 /**
- * Contains the mesh's properties, it's vertices and triangles. The transformation_matrix is computed automatically, not input required.
+ * Contains the mesh's properties, it's vertices and triangles. Geometry is stored in contiguous arrays:
+ * positions holds xyz for every vertex (vertices_count * 3 floats), indices holds 3 vertex indices per triangle
+ * (triangles_count * 3) and colors holds one packed ARGB8888 color per triangle (see SGL_PackColor).
+ * The transformation_matrix is computed automatically, not input required. It is only recomputed when the mesh
+ * moved so change position, orientation and scale with SGL_MeshSetPosition/Orientation/Scale (writing them
+ * directly won't be picked up). Static meshes (see SGL_MeshSetStatic) also keep their world space vertices.
  */
 typedef struct {
     SGL_Vector3 position;
     SGL_Vector3 orientation;
     SGL_Vector3 scale;
-    SGL_List *vertices;
-    SGL_List *triangles;
+    float *positions;
+    float_safe_index_t vertices_count;
+    float_safe_index_t *indices;
+    uint32_t *colors;
+    float_safe_index_t triangles_count;
     float transformation_matrix[16];
+    bool transformation_dirty; // transformation_matrix has to be recomputed before the next frame
+    bool is_static;
+    float *world_vertices; // xyzw in world space (vertices_count * 4), only for static meshes, allocated by SGL_MeshSetStatic
+    bool world_vertices_dirty; // world_vertices has to be rebuilt before the next frame
+    bool changed; // Set by the setters, cleared once the mesh or one of its instances is drawn (lets the renderer skip frames where nothing changed)
 } SGL_Mesh;
 
 /**
- * Contains it's position and a pointer to the mesh it was placed in (used for converting position from local space to world space).
+ * Vertex in local space of the mesh. Only used to describe geometry to SGL_CreateMesh.
  */
 typedef struct {
     SGL_Vector3 position;
-    SGL_Mesh *mesh;
 } SGL_Vertex;
 
 /**
- * Contains pointers to 3 vertices and it's color.
+ * Contains pointers to 3 vertices and it's color. The pointers must point inside the vertices array given to SGL_CreateMesh.
  */
 typedef struct {
     SGL_Vertex *vertex1;
@@ -118,11 +131,88 @@ typedef struct {
     SGL_Color color;
 } SGL_Triangle;
 
+/**
+ * Packs a color in ARGB8888 (the format of the renderer's texture). Channels are clamped to [0, 1].
+ * \param color Color to pack
+ * \returns Packed color
+ */
+uint32_t SGL_PackColor(SGL_Color color);
+
+/**
+ * Creates a mesh from indexed geometry. All arrays are copied, the caller keeps ownership of them.
+ * \param positions xyz of every vertex in local space (vertices_count * 3 floats)
+ * \param vertices_count Amount of vertices
+ * \param indices 3 vertex indices per triangle (triangles_count * 3 indices)
+ * \param triangles_count Amount of triangles
+ * \param colors Packed ARGB8888 color per triangle (see SGL_PackColor) or NULL for white
+ * \returns Mesh or NULL if an index is out of range
+ */
+SGL_Mesh* SGL_CreateIndexedMesh(const float *positions, float_safe_index_t vertices_count, const float_safe_index_t *indices, float_safe_index_t triangles_count, const uint32_t *colors, SGL_Vector3 position, SGL_Vector3 orientation, SGL_Vector3 scale);
+/**
+ * Creates a mesh from vertices and triangles (the triangles' pointers must point inside vertices). The data is copied
+ * into an indexed mesh (see SGL_CreateIndexedMesh), vertices and triangles can be freed after.
+ * \returns Mesh or NULL if a triangle points outside of vertices
+ */
 SGL_Mesh* SGL_CreateMesh(SGL_Vertex vertices[], float_safe_index_t vertices_count, SGL_Triangle triangles[], float_safe_index_t triangles_count, SGL_Vector3 position, SGL_Vector3 orientation, SGL_Vector3 scale);
 /**
  * Free a mesh passed as argument (All vertices and triangles are freed too).
  */
 void SGL_FreeMesh(SGL_Mesh *mesh);
+/**
+ * Moves the mesh, the transformation matrix is recomputed on the next frame.
+ */
+void SGL_MeshSetPosition(SGL_Mesh *mesh, SGL_Vector3 position);
+/**
+ * Rotates the mesh (euler angles in degrees), the transformation matrix is recomputed on the next frame.
+ */
+void SGL_MeshSetOrientation(SGL_Mesh *mesh, SGL_Vector3 orientation);
+/**
+ * Scales the mesh, the transformation matrix is recomputed on the next frame.
+ */
+void SGL_MeshSetScale(SGL_Mesh *mesh, SGL_Vector3 scale);
+/**
+ * Replaces the positions of the vertices (same amount of vertices, positions is copied).
+ * \param positions xyz of every vertex in local space (vertices_count * 3 floats)
+ */
+void SGL_MeshSetPositions(SGL_Mesh *mesh, const float *positions);
+/**
+ * A static mesh keeps its vertices in world space between frames so they are only transformed by the camera.
+ * The cache is rebuilt when the mesh moves or its positions change. Use it for meshes that rarely move
+ * (it costs 16 bytes per vertex).
+ */
+void SGL_MeshSetStatic(SGL_Mesh *mesh, bool is_static);
+
+/**
+ * Draws the geometry of a mesh with its own transform without copying the geometry. Add it to scene->instances.
+ * The mesh only provides the vertices and triangles (its own transform is ignored) and doesn't have to be in
+ * scene->meshes. Like meshes, change position, orientation and scale with the setters.
+ */
+typedef struct {
+    SGL_Mesh *mesh;
+    SGL_Vector3 position;
+    SGL_Vector3 orientation;
+    SGL_Vector3 scale;
+    uint32_t tint; // Packed color multiplied with the triangles' colors (0xFFFFFFFF leaves them unchanged)
+    float transformation_matrix[16];
+    bool transformation_dirty;
+    bool changed; // Set by the setters, cleared once the instance is drawn
+} SGL_MeshInstance;
+
+/**
+ * \param mesh Mesh the geometry is taken from. It is not copied so it must outlive the instance.
+ */
+SGL_MeshInstance* SGL_CreateMeshInstance(SGL_Mesh *mesh, SGL_Vector3 position, SGL_Vector3 orientation, SGL_Vector3 scale);
+/**
+ * Frees the instance only, the mesh is managed by the user.
+ */
+void SGL_FreeMeshInstance(SGL_MeshInstance *instance);
+void SGL_MeshInstanceSetPosition(SGL_MeshInstance *instance, SGL_Vector3 position);
+void SGL_MeshInstanceSetOrientation(SGL_MeshInstance *instance, SGL_Vector3 orientation);
+void SGL_MeshInstanceSetScale(SGL_MeshInstance *instance, SGL_Vector3 scale);
+/**
+ * Multiplies the color of every triangle of the instance by tint ({1, 1, 1} removes the tint).
+ */
+void SGL_MeshInstanceSetTint(SGL_MeshInstance *instance, SGL_Color tint);
 
 // Mesh Templates
 SGL_Mesh* SGL_CreateCubeMesh(SGL_Vector3 position);
@@ -139,21 +229,185 @@ typedef struct SGL_Renderer SGL_Renderer;
  * \param scene Pointer to SGL scene to render
  */
 SGL_Renderer* SGL_CreateRenderer(const char *name, SGL_Scene *scene);
+/**
+ * Creates a renderer without window (no SDL video, no texture, nothing presented) that renders in a
+ * memory buffer you can read with SGL_RendererGetPixels. Useful for servers, thumbnails and benchmarks.
+ * Render with SGL_RenderFrame.
+ * \param width Width of the image in pixels
+ * \param height Height of the image in pixels
+ * \param scene Pointer to SGL scene to render
+ * \returns Renderer or NULL if the size is invalid or the buffers couldn't be allocated
+ */
+SGL_Renderer* SGL_CreateOffscreenRenderer(int width, int height, SGL_Scene *scene);
 void SGL_FreeRenderer(SGL_Renderer *renderer);
 /**
- * Renders the scene passed as an argument at creation.
+ * Handles the window events SGL cares about (quit, resize, fullscreen with F11, etc.). Call it for every polled event.
  * \param event Pointer to polled SDL_Event
+ * \returns false if the window was closed and you should stop
+ */
+bool SGL_ProcessEvent(SGL_Renderer *renderer, SDL_Event *event);
+/**
+ * Renders the scene passed as an argument at creation. Call it once per frame, after processing the events.
+ * The pipeline is skipped when nothing changed since the last frame: no mesh or instance was added, removed or
+ * modified with a setter, the camera didn't move and the window wasn't resized. If you modify a mesh directly
+ * (eg: its colors), call SGL_RendererRequestRedraw.
+ */
+void SGL_RenderFrame(SGL_Renderer *renderer);
+/**
+ * SGL_ProcessEvent followed by SGL_RenderFrame. Kept for code written before they were split, it renders once per
+ * event so prefer calling them separately (or SGL_Run).
+ * \param event Pointer to polled SDL_Event
+ * \returns false if the window was closed
  */
 bool SGL_Render(SGL_Renderer *renderer, SDL_Event *event);
+
+/**
+ * Called at a fixed rate by SGL_Run, put the logic of your program here (movements, animations, etc.).
+ * \param step Duration of one update in seconds, always the same
+ */
+typedef void (*SGL_UpdateCallback)(SGL_Renderer *renderer, float step, void *user_data);
+/**
+ * Called by SGL_Run for every SDL event after SGL_ProcessEvent.
+ * \returns false to stop SGL_Run
+ */
+typedef bool (*SGL_EventCallback)(SGL_Renderer *renderer, SDL_Event *event, void *user_data);
+
+/**
+ * How SGL_Run paces frames. Zero-initialize it and set what you need.
+ */
+typedef struct {
+    int target_fps; // Frames per second SGL_Run sleeps to stay at, 0 for no limit
+    bool vsync; // Wait for the screen refresh when presenting (usually with target_fps = 0)
+    float update_rate; // Fixed updates per second (60 if 0)
+    SGL_UpdateCallback update; // Can be NULL
+    SGL_EventCallback event; // Can be NULL
+    void *user_data; // Passed to the callbacks
+} SGL_FramePacing;
+
+/**
+ * Runs the main loop until the window is closed (or the event callback returns false): processes all pending events,
+ * runs the fixed updates for the time that passed, renders one frame and waits for the next one. The amount of
+ * frames doesn't depend on the amount of events and updates run at the same rate whatever the frame rate is.
+ * Without target_fps, a frame skipped because nothing changed sleeps until the next update instead of spinning.
+ */
+void SGL_Run(SGL_Renderer *renderer, const SGL_FramePacing *pacing);
 /**
  * Change scene for this renderer.
  */
 void SGL_RendererSetScene(SGL_Renderer *renderer, SGL_Scene *scene);
 /**
- * Get the SDL window (only if you know what you're doing). I created the abstraction
+ * Forces the next SGL_Render to run the pipeline even if no change was detected in the scene.
+ */
+void SGL_RendererRequestRedraw(SGL_Renderer *renderer);
+/**
+ * Size of the square screen tiles the triangles are sorted into before being drawn, so every tile is drawn with its
+ * pixels and depth in cache. Rounded up to a multiple of 8 and capped to 65536, default 64. 0 draws every triangle on the whole screen
+ * at once (no binning). The image is the same for any size.
+ */
+void SGL_RendererSetTileSize(SGL_Renderer *renderer, int tile_size);
+/**
+ * Amount of threads drawing the tiles, the calling thread included. They are created once on the next frame and
+ * wait between frames. 0 (default) uses every logical core, 1 draws on the calling thread only. Capped to 64 and
+ * ignored when the tile size is 0. The image is the same for any count.
+ */
+void SGL_RendererSetThreadCount(SGL_Renderer *renderer, int threads_count);
+/**
+ * Versions of the rasterizer's inner loop, see SGL_RendererSetRasterPath.
+ */
+typedef enum {
+    SGL_RASTER_AUTO, // Widest one the CPU supports (default)
+    SGL_RASTER_SCALAR,
+    SGL_RASTER_SSE2,
+    SGL_RASTER_AVX2
+} SGL_RasterPath;
+/**
+ * Forces the version of the rasterizer's inner loop. They all give the same images, this is for testing and comparing
+ * them (sgl_bench --check runs the golden images with each one).
+ * \returns false if this build or the CPU doesn't support the path, the current one is kept
+ */
+bool SGL_RendererSetRasterPath(SGL_Renderer *renderer, SGL_RasterPath path);
+/**
+ * Get the SDL window (only if you know what you're doing, NULL for offscreen renderers). I created the abstraction
  * layer so you don't have to deal with the window itself but if you wanna tweak it and add your own stuff feel free.
  */
 SDL_Window* SGL_RendererGetWindow(SGL_Renderer *renderer);
+/**
+ * Color buffer of an offscreen renderer (see SGL_CreateOffscreenRenderer) holding the last rendered frame.
+ * Pixels are ARGB8888, row by row without padding (width * height, see SGL_RendererGetSize). The pointer
+ * stays valid until the renderer is freed.
+ * \returns Pixels or NULL for a renderer with a window (its pixels live in an SDL texture)
+ */
+const uint32_t* SGL_RendererGetPixels(SGL_Renderer *renderer);
+/**
+ * Depth buffer of the last rendered frame, one float per pixel laid out like the pixels of SGL_RendererGetPixels.
+ * Pixels where nothing was drawn hold FLT_MAX. The pointer changes when the window is resized.
+ */
+const float* SGL_RendererGetDepthBuffer(SGL_Renderer *renderer);
+/**
+ * Size of the image rendered in pixels (the window size for a renderer with a window).
+ */
+void SGL_RendererGetSize(SGL_Renderer *renderer, int *width, int *height);
+/**
+ * Stages of the pipeline timed in SGL_FrameStats.
+ */
+typedef enum {
+    SGL_STAGE_FLATTEN, // Scene to flat arrays, includes the local space -> clip space transform
+    SGL_STAGE_CULL,
+    SGL_STAGE_CLIP,
+    SGL_STAGE_DIVIDE, // Perspective division
+    SGL_STAGE_VIEWPORT, // NDC space -> Screen space
+    SGL_STAGE_RASTER, // Clearing the buffers and filling the triangles
+    SGL_STAGE_PRESENT, // Showing the texture in the window (0 for offscreen renderers)
+    SGL_STAGE_COUNT
+} SGL_Stage;
+
+/**
+ * Amount of work done by each stage of the pipeline during a frame. Clipping planes are in this order:
+ * left, right, top, bottom, near, far.
+ */
+typedef struct {
+    Uint64 vertices_in; // Vertices of all meshes and instances
+    Uint64 triangles_in; // Triangles of all meshes and instances
+    Uint64 triangles_culled; // Facing away from the camera (removed by cull)
+    Uint64 triangles_discarded[6]; // Entirely outside of the plane
+    Uint64 triangles_clipped[6]; // Crossing the plane, cut to the part inside
+    Uint64 triangles_generated[6]; // Extra triangles created when the part inside was a quad
+    Uint64 triangles_rasterized; // Set up and drawn, without the degenerate ones and the ones covering no pixel center
+    Uint64 pixels_tested; // Pixels tested one by one for coverage, in the blocks of the bounding boxes partly covered by a triangle
+    Uint64 depth_passed; // Covered pixels closer than what was already drawn
+    Uint64 depth_failed; // Covered pixels behind what was already drawn
+    Uint64 pixels_written;
+} SGL_PipelineStats;
+
+/**
+ * Timings (in nanoseconds) and pipeline statistics of the last frame that ran the pipeline.
+ */
+typedef struct {
+    SGL_PipelineStats pipeline;
+    Uint64 stage_ns[SGL_STAGE_COUNT];
+    Uint64 frame_ns; // Whole frame (stages and bookkeeping between them)
+    Uint64 frames_rendered; // Frames that ran the pipeline since the renderer was created
+    Uint64 frames_skipped; // SGL_RenderFrame calls skipped because nothing changed
+} SGL_FrameStats;
+
+/**
+ * Gives the timings and pipeline statistics of the last rendered frame. Timings are measured with SDL_GetPerformanceCounter
+ * around every stage and statistics are counted by the stages themselves (cheap enough to keep in production), compile
+ * SGL with SGL_DISABLE_FRAME_STATS defined to remove both from the pipeline.
+ * \param out Where the stats are copied
+ * \returns false if SGL was compiled without frame stats (out is left untouched)
+ */
+bool SGL_RendererGetFrameStats(SGL_Renderer *renderer, SGL_FrameStats *out);
+/**
+ * \returns Short lowercase name of the stage (eg: "cull") for logs
+ */
+const char* SGL_StageName(SGL_Stage stage);
+
+/**
+ * Every stage of the pipeline allocates its output from a frame arena that is reset after each frame.
+ * \returns Most bytes the arena ever had to hold in one frame (useful to check the memory a scene needs).
+ */
+size_t SGL_RendererGetFrameArenaHighWaterMark(SGL_Renderer *renderer);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,55 @@
+#ifndef SGL_Buffer_h
+#define SGL_Buffer_h
+
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+
+#include "SGL_List.h"
+#include "SGL_FrameArena.h"
+
+/**
+ * Resizable contiguous array of floats. Unlike SGL_List, values are stored inline so adding
+ * a value never allocates memory for the value itself (only when the capacity has to grow).
+ * Used by the pipeline stages for the flat vertices and triangles arrays, the buffer and its items
+ * live in a frame arena so they are released all at once when it is reset.
+ */
+typedef struct {
+    float *items;
+    float_safe_index_t size;
+    float_safe_index_t capacity;
+    SGL_FrameArena *arena;
+} SGL_FloatBuffer;
+
+/**
+ * \param capacity Amount of floats to reserve up front (avoid regrowing if you know the final size).
+ */
+SGL_FloatBuffer* SGL_CreateFloatBufferInArena(SGL_FrameArena *arena, float_safe_index_t capacity);
+/**
+ * Makes sure the buffer can hold at least capacity floats without regrowing.
+ */
+void SGL_FloatBufferReserve(SGL_FloatBuffer *buffer, float_safe_index_t capacity);
+/**
+ * Copies count values at the end of the buffer.
+ */
+void SGL_FloatBufferAddArray(SGL_FloatBuffer *buffer, const float *values, float_safe_index_t count);
+/**
+ * Sets the size back to 0 but keeps the memory for the next use.
+ */
+void SGL_FloatBufferClear(SGL_FloatBuffer *buffer);
+
+/**
+ * Same as SGL_FloatBuffer but for indices (used for the triangles which are vertex indices and a packed color).
+ */
+typedef struct {
+    float_safe_index_t *items;
+    float_safe_index_t size;
+    float_safe_index_t capacity;
+    SGL_FrameArena *arena;
+} SGL_IndexBuffer;
+
+SGL_IndexBuffer* SGL_CreateIndexBufferInArena(SGL_FrameArena *arena, float_safe_index_t capacity);
+void SGL_IndexBufferReserve(SGL_IndexBuffer *buffer, float_safe_index_t capacity);
+void SGL_IndexBufferAddArray(SGL_IndexBuffer *buffer, const float_safe_index_t *values, float_safe_index_t count);
+void SGL_IndexBufferClear(SGL_IndexBuffer *buffer);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SGL_FrameArena_h
+#define SGL_FrameArena_h
+
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+
+/**
+ * Every allocation is aligned on a cache line.
+ */
+#define SGL_FRAME_ARENA_ALIGNMENT 64
+
+/**
+ * Bump allocator for the data that only lives during one frame. Allocating just moves an offset inside one
+ * block of memory and everything is released at once with SGL_FrameArenaReset (nothing is freed individually).
+ * If a frame needs more than the block, the extra allocations go in overflow blocks and the main block is
+ * regrown to the high-water mark on the next reset, so once the biggest frame was seen no more heap allocations happen.
+ */
+typedef struct {
+    unsigned char *base;
+    size_t capacity;
+    size_t offset;
+    void *last_allocation; // Can be grown in place
+    void *overflow_blocks; // Linked list of the blocks allocated when base was full
+    size_t overflow_size;
+    size_t high_water_mark;
+} SGL_FrameArena;
+
+SGL_FrameArena* SGL_CreateFrameArena(size_t capacity);
+/**
+ * \returns Memory valid until the next reset (never NULL unless the system is out of memory).
+ */
+void* SGL_FrameArenaAlloc(SGL_FrameArena *arena, size_t size);
+/**
+ * Grows an allocation of this arena, in place if it was the last one and there is room left,
+ * otherwise the data is copied to a new allocation (the old one is only released at reset).
+ */
+void* SGL_FrameArenaGrow(SGL_FrameArena *arena, void *allocation, size_t old_size, size_t new_size);
+/**
+ * Releases every allocation at once. O(1) except after a frame that overflowed where the block is regrown.
+ */
+void SGL_FrameArenaReset(SGL_FrameArena *arena);
+/**
+ * \returns Most bytes ever used in one frame (padding included).
+ */
+size_t SGL_FrameArenaGetHighWaterMark(SGL_FrameArena *arena);
+void SGL_FreeFrameArena(SGL_FrameArena *arena);
+
+#endif
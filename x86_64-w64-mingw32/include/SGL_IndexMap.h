@@ -0,0 +1,55 @@
+#ifndef SGL_IndexMap_h
+#define SGL_IndexMap_h
+
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+
+#include "SGL_List.h"
+
+/**
+ * Key used to mark a free slot, it can't be used as a key.
+ */
+#define SGL_INDEX_MAP_EMPTY_KEY ((float_safe_index_t)-1)
+
+typedef struct {
+    float_safe_index_t key;
+    float_safe_index_t value;
+} SGL_IndexMapEntry;
+
+/**
+ * Hash map from index to index using open addressing (linear probing). Unlike SGL_HashMap, keys and values
+ * are stored inline in one contiguous array of entries so putting or getting never allocates memory
+ * (only when the capacity has to grow) and clearing keeps the memory for the next use.
+ */
+typedef struct {
+    SGL_IndexMapEntry *entries;
+    float_safe_index_t capacity;
+    float_safe_index_t size;
+} SGL_IndexMap;
+
+/**
+ * \param capacity Amount of entries to reserve up front.
+ */
+SGL_IndexMap* SGL_CreateIndexMap(float_safe_index_t capacity);
+/**
+ * Makes sure the map can hold at least count entries without regrowing.
+ */
+void SGL_IndexMapReserve(SGL_IndexMap *map, float_safe_index_t count);
+void SGL_IndexMapPut(SGL_IndexMap *map, float_safe_index_t key, float_safe_index_t value);
+/**
+ * \returns true and writes the value in out_value if the key was found.
+ */
+bool SGL_IndexMapGet(SGL_IndexMap *map, float_safe_index_t key, float_safe_index_t *out_value);
+void SGL_IndexMapRemove(SGL_IndexMap *map, float_safe_index_t key);
+/**
+ * Removes every entry but keeps the memory for the next use.
+ */
+void SGL_IndexMapClear(SGL_IndexMap *map);
+/**
+ * Iterates over the entries in no particular order. Start with *iterator set to 0 and call it until it returns false.
+ * The map must not be modified while iterating.
+ */
+bool SGL_IndexMapNext(SGL_IndexMap *map, float_safe_index_t *iterator, float_safe_index_t *out_key, float_safe_index_t *out_value);
+void SGL_FreeIndexMap(SGL_IndexMap *map);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef SGL_ThreadPool_h
+#define SGL_ThreadPool_h
+
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+
+/**
+ * Work given to every worker of a pool by SGL_ThreadPoolRun.
+ * \param data Pointer given to SGL_ThreadPoolRun, shared by all the workers
+ * \param worker_index 0 for the calling thread, 1 to workers count - 1 for the pool threads
+ */
+typedef void (*SGL_ThreadPoolJob)(void *data, int worker_index);
+
+typedef struct SGL_ThreadPoolWorker SGL_ThreadPoolWorker;
+
+/**
+ * Persistent worker threads that run the same job together. The threads are created once and sleep on a semaphore
+ * between runs so running a job doesn't create any thread. The calling thread is worker 0 and works too, so a pool
+ * of 1 worker has no thread and just calls the job.
+ * The pool doesn't split the work: the job pulls its own items (for example with an SDL_AtomicInt counter).
+ */
+typedef struct {
+    SGL_ThreadPoolWorker *workers; // workers_count - 1 threads, the calling thread is worker 0
+    int workers_count;
+    SDL_Semaphore *done; // Signaled by every thread when it finished the job
+    SGL_ThreadPoolJob job;
+    void *job_data;
+    bool quit;
+} SGL_ThreadPool;
+
+/**
+ * \param workers_count Threads working on a job, the calling thread included (at least 1)
+ * \returns NULL if a thread couldn't be created.
+ */
+SGL_ThreadPool* SGL_CreateThreadPool(int workers_count);
+/**
+ * Runs job on every worker and returns once they all finished. Not reentrant: only one thread runs jobs on a pool.
+ */
+void SGL_ThreadPoolRun(SGL_ThreadPool *pool, SGL_ThreadPoolJob job, void *data);
+int SGL_ThreadPoolGetWorkersCount(SGL_ThreadPool *pool);
+/**
+ * Stops and waits for every thread.
+ */
+void SGL_FreeThreadPool(SGL_ThreadPool *pool);
+
+#endif
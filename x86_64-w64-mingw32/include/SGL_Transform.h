@@ -0,0 +1,44 @@
+#ifndef SGL_Transform_h
+#define SGL_Transform_h
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_intrin.h>
+
+#include "SGL_List.h"
+
+/**
+ * Batch vertex transforms used by the pipeline. Vertices are xyzw (4 floats each, the layout of the flat
+ * vertices arrays) and are multiplied as row vectors: out = v * m, so m[12..14] is the translation.
+ * The SIMD paths do the same multiplies and adds in the same order as the scalar one so they give the
+ * same results, they only do more vertices at once. in and out can be the same array.
+ */
+
+/**
+ * Transforms count vertices with the fastest path the CPU supports (picked on the first call).
+ * \param m Matrix (same layout as every matrix in SGL)
+ * \param in Vertices to transform (count * 4 floats)
+ * \param out Transformed vertices (count * 4 floats)
+ * \param count Amount of vertices
+ */
+void SGL_TransformVertices(const float m[16], const float *in, float *out, float_safe_index_t count);
+
+/**
+ * Reference path, one vertex at a time. Always available.
+ */
+void SGL_TransformVerticesScalar(const float m[16], const float *in, float *out, float_safe_index_t count);
+
+#ifdef SDL_SSE2_INTRINSICS
+/**
+ * 4 vertices per iteration, one vertex per 128 bits register. Only call it if SDL_HasSSE2().
+ */
+void SGL_TransformVerticesSSE2(const float m[16], const float *in, float *out, float_safe_index_t count);
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+/**
+ * 8 vertices per iteration, two vertices per 256 bits register. Only call it if SDL_HasAVX2().
+ */
+void SGL_TransformVerticesAVX2(const float m[16], const float *in, float *out, float_safe_index_t count);
+#endif
+
+#endif
@@ -6,8 +6,11 @@
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 
 #include "SGL.h"
-#include "SGL_HashMap.h"
-#include <stdio.h>
+#include "SGL_Buffer.h"
+#include "SGL_IndexMap.h"
+#include "SGL_FrameArena.h"
+#include "SGL_Transform.h"
+#include "SGL_ThreadPool.h"
 #include <float.h>
 
 const SGL_Color SGL_RED = {.r = 1.0f, .g = 0.0f, .b = 0.0f};
@@ -16,7 +19,57 @@ const SGL_Color SGL_BLUE = {.r = 0.0f, .g = 0.0f, .b = 1.0f};
 
 // Engine constants
 static const int VERTEX_ARRAY_SIZE = 4;
-static const int TRIANGLE_ARRAY_SIZE = 6;
+static const int TRIANGLE_ARRAY_SIZE = 4; // 3 vertex indices and a packed color
+static const size_t CACHE_LINE_SIZE = 64;
+static const float DEFAULT_UPDATE_RATE = 60.0f; // Fixed updates per second of SGL_Run when none is given
+static const Uint64 MAX_UPDATES_PER_FRAME = 8;
+#define RASTER_SPAN 8 // Pixels of a row evaluated from the same exact edge values, tiles are made of whole spans
+#define RASTER_BLOCK 8 // Side of the squares tested against the edges before their pixels, one span wide so tiles are made of whole blocks
+#define SMALL_TRIANGLE_SIZE 2 // Bounding boxes of at most this many pixels on both sides skip the span and block set up
+#define SUBPIXEL_BITS 4 // Screen positions are snapped to 28.4 fixed point before rasterizing
+#define SUBPIXEL_SCALE (1 << SUBPIXEL_BITS)
+#define EDGE_CLAMP (1 << 30) // Edge values are clamped to it for the 32 bits lanes, far more than a span can change them
+static const int DEFAULT_TILE_SIZE = 64;
+static const int MAX_TILE_SIZE = 1 << 16; // Larger sizes are clamped to it, already one tile for any real screen
+static const int MAX_THREADS_COUNT = 64;
+
+// Frame stats instrumentation of SGL_RenderFrame, removed entirely when compiled with SGL_DISABLE_FRAME_STATS.
+// PIPELINE_STATS is where the stages write their counters, NULL when disabled so they skip it.
+#ifdef SGL_DISABLE_FRAME_STATS
+#define FRAME_STATS_BEGIN(renderer)
+#define FRAME_STATS_STAGE(renderer, stage)
+#define FRAME_STATS_END(renderer)
+#define FRAME_STATS_SKIPPED(renderer)
+#define PIPELINE_STATS(renderer) NULL
+#else
+static Uint64 counter_to_ns(Uint64 counter) {
+    static Uint64 frequency = 0;
+    if (frequency == 0) {
+        frequency = SDL_GetPerformanceFrequency();
+    }
+
+    // Split so counter * SDL_NS_PER_SECOND can't overflow
+    return (counter / frequency) * SDL_NS_PER_SECOND + (counter % frequency) * SDL_NS_PER_SECOND / frequency;
+}
+
+// Stages and counters a frame skips (empty scene) stay at 0
+#define FRAME_STATS_BEGIN(renderer) \
+    memset((renderer)->frame_stats.stage_ns, 0, sizeof((renderer)->frame_stats.stage_ns)); \
+    memset(&(renderer)->frame_stats.pipeline, 0, sizeof(SGL_PipelineStats)); \
+    Uint64 frame_stats_start = SDL_GetPerformanceCounter(); \
+    Uint64 frame_stats_last = frame_stats_start
+#define FRAME_STATS_STAGE(renderer, stage) do { \
+        Uint64 frame_stats_now = SDL_GetPerformanceCounter(); \
+        (renderer)->frame_stats.stage_ns[stage] = counter_to_ns(frame_stats_now - frame_stats_last); \
+        frame_stats_last = frame_stats_now; \
+    } while (0)
+#define FRAME_STATS_END(renderer) do { \
+        (renderer)->frame_stats.frame_ns = counter_to_ns(SDL_GetPerformanceCounter() - frame_stats_start); \
+        (renderer)->frame_stats.frames_rendered++; \
+    } while (0)
+#define FRAME_STATS_SKIPPED(renderer) ((renderer)->frame_stats.frames_skipped++)
+#define PIPELINE_STATS(renderer) (&(renderer)->frame_stats.pipeline)
+#endif
 
 static const float planes_constants[6][4] = {
     {1.0f, 0.0f, 0.0f, -1.0f}, // Left
@@ -35,70 +88,219 @@ float SGL_Cot(float degrees) {
     return 1.0f / tan(SGL_DegToRad(degrees));
 }
 
-SGL_Mesh* SGL_CreateMesh(SGL_Vertex vertices[], float_safe_index_t vertices_count, SGL_Triangle triangles[], float_safe_index_t triangles_count, SGL_Vector3 position, SGL_Vector3 orientation, SGL_Vector3 scale) {
-    SGL_List *vertices_list = SGL_CreateListFromArray(vertices, vertices_count, sizeof(SGL_Vertex));
-    SGL_List *triangles_list = SGL_CreateListFromArray(triangles, triangles_count, sizeof(SGL_Triangle));
+uint32_t SGL_PackColor(SGL_Color color) {
+    uint32_t r = (uint32_t)(SDL_clamp(color.r, 0.0f, 1.0f) * 255.0f + 0.5f);
+    uint32_t g = (uint32_t)(SDL_clamp(color.g, 0.0f, 1.0f) * 255.0f + 0.5f);
+    uint32_t b = (uint32_t)(SDL_clamp(color.b, 0.0f, 1.0f) * 255.0f + 0.5f);
 
-    SGL_Mesh *mesh = malloc(sizeof(SGL_Mesh));
-    mesh->vertices = vertices_list;
+    return (0xFFu << 24) | (r << 16) | (g << 8) | b;
+}
 
-    for (float_safe_index_t i = 0; i < vertices_list->size; i++)
+SGL_Mesh* SGL_CreateIndexedMesh(const float *positions, float_safe_index_t vertices_count, const float_safe_index_t *indices, float_safe_index_t triangles_count, const uint32_t *colors, SGL_Vector3 position, SGL_Vector3 orientation, SGL_Vector3 scale) {
+    for (float_safe_index_t i = 0; i < triangles_count * 3; i++)
     {
-        SGL_Vertex *vertex = (SGL_Vertex *)vertices_list->items[i];
-        vertex->mesh = mesh;
+        if (indices[i] >= vertices_count) {
+            SDL_Log("Mesh creation failed: triangle %" PRIu32 " uses vertex %" PRIu32 " but the mesh only has %" PRIu32 " vertices\n", i / 3, indices[i], vertices_count);
+            return NULL;
+        }
+    }
+
+    SGL_Mesh *mesh = malloc(sizeof(SGL_Mesh));
+    mesh->vertices_count = vertices_count;
+    mesh->triangles_count = triangles_count;
+    mesh->positions = malloc(sizeof(float) * vertices_count * 3);
+    mesh->indices = malloc(sizeof(float_safe_index_t) * triangles_count * 3);
+    mesh->colors = malloc(sizeof(uint32_t) * triangles_count);
+
+    memcpy(mesh->positions, positions, sizeof(float) * vertices_count * 3);
+    memcpy(mesh->indices, indices, sizeof(float_safe_index_t) * triangles_count * 3);
+
+    if (colors != NULL) {
+        memcpy(mesh->colors, colors, sizeof(uint32_t) * triangles_count);
+    } else {
+        for (float_safe_index_t i = 0; i < triangles_count; i++) {
+            mesh->colors[i] = 0xFFFFFFFF;
+        }
     }
 
-    mesh->triangles = triangles_list;
     mesh->position = position;
     mesh->orientation = orientation;
     mesh->scale = scale;
+    mesh->transformation_dirty = true;
+    mesh->is_static = false;
+    mesh->world_vertices = NULL;
+    mesh->world_vertices_dirty = true;
+    mesh->changed = true;
+
+    return mesh;
+}
+
+SGL_Mesh* SGL_CreateMesh(SGL_Vertex vertices[], float_safe_index_t vertices_count, SGL_Triangle triangles[], float_safe_index_t triangles_count, SGL_Vector3 position, SGL_Vector3 orientation, SGL_Vector3 scale) {
+    float *positions = malloc(sizeof(float) * vertices_count * 3);
+    float_safe_index_t *indices = malloc(sizeof(float_safe_index_t) * triangles_count * 3);
+    uint32_t *colors = malloc(sizeof(uint32_t) * triangles_count);
+
+    for (float_safe_index_t i = 0; i < vertices_count; i++)
+    {
+        positions[i * 3] = vertices[i].position.x;
+        positions[i * 3 + 1] = vertices[i].position.y;
+        positions[i * 3 + 2] = vertices[i].position.z;
+    }
+
+    // Triangles point inside the vertices array so the index is just the distance from its start
+    // (anything outside the array becomes an invalid index and the creation fails)
+    for (float_safe_index_t i = 0; i < triangles_count; i++)
+    {
+        SGL_Triangle *triangle = &triangles[i];
+        indices[i * 3] = (float_safe_index_t)(triangle->vertex1 - vertices);
+        indices[i * 3 + 1] = (float_safe_index_t)(triangle->vertex2 - vertices);
+        indices[i * 3 + 2] = (float_safe_index_t)(triangle->vertex3 - vertices);
+        colors[i] = SGL_PackColor(triangle->color);
+    }
+
+    SGL_Mesh *mesh = SGL_CreateIndexedMesh(positions, vertices_count, indices, triangles_count, colors, position, orientation, scale);
+
+    free(positions);
+    free(indices);
+    free(colors);
 
     return mesh;
 }
 
 void SGL_FreeMesh(SGL_Mesh *mesh) {
     // Free memory of things inside the mesh (vertices and triangles data)
-    SGL_FreeList(mesh->vertices, true);
-    SGL_FreeList(mesh->triangles, true);
+    free(mesh->positions);
+    free(mesh->indices);
+    free(mesh->colors);
+    free(mesh->world_vertices);
     free(mesh);
 }
 
+void SGL_MeshSetPosition(SGL_Mesh *mesh, SGL_Vector3 position) {
+    mesh->position = position;
+    mesh->transformation_dirty = true;
+    mesh->changed = true;
+}
+
+void SGL_MeshSetOrientation(SGL_Mesh *mesh, SGL_Vector3 orientation) {
+    mesh->orientation = orientation;
+    mesh->transformation_dirty = true;
+    mesh->changed = true;
+}
+
+void SGL_MeshSetScale(SGL_Mesh *mesh, SGL_Vector3 scale) {
+    mesh->scale = scale;
+    mesh->transformation_dirty = true;
+    mesh->changed = true;
+}
+
+void SGL_MeshSetPositions(SGL_Mesh *mesh, const float *positions) {
+    memcpy(mesh->positions, positions, sizeof(float) * mesh->vertices_count * 3);
+    mesh->world_vertices_dirty = true;
+    mesh->changed = true;
+}
+
+void SGL_MeshSetStatic(SGL_Mesh *mesh, bool is_static) {
+    mesh->is_static = is_static;
+
+    // Allocated here so the frames only fill it, the vertices count never changes
+    if (is_static && mesh->world_vertices == NULL) {
+        mesh->world_vertices = malloc(sizeof(float) * mesh->vertices_count * VERTEX_ARRAY_SIZE);
+    } else if (!is_static) {
+        free(mesh->world_vertices);
+        mesh->world_vertices = NULL;
+    }
+
+    mesh->world_vertices_dirty = true;
+    mesh->changed = true;
+}
+
+SGL_MeshInstance* SGL_CreateMeshInstance(SGL_Mesh *mesh, SGL_Vector3 position, SGL_Vector3 orientation, SGL_Vector3 scale) {
+    SGL_MeshInstance *instance = malloc(sizeof(SGL_MeshInstance));
+    instance->mesh = mesh;
+    instance->position = position;
+    instance->orientation = orientation;
+    instance->scale = scale;
+    instance->tint = 0xFFFFFFFF;
+    instance->transformation_dirty = true;
+    instance->changed = true;
+    return instance;
+}
+
+void SGL_FreeMeshInstance(SGL_MeshInstance *instance) {
+    free(instance);
+}
+
+void SGL_MeshInstanceSetPosition(SGL_MeshInstance *instance, SGL_Vector3 position) {
+    instance->position = position;
+    instance->transformation_dirty = true;
+    instance->changed = true;
+}
+
+void SGL_MeshInstanceSetOrientation(SGL_MeshInstance *instance, SGL_Vector3 orientation) {
+    instance->orientation = orientation;
+    instance->transformation_dirty = true;
+    instance->changed = true;
+}
+
+void SGL_MeshInstanceSetScale(SGL_MeshInstance *instance, SGL_Vector3 scale) {
+    instance->scale = scale;
+    instance->transformation_dirty = true;
+    instance->changed = true;
+}
+
+void SGL_MeshInstanceSetTint(SGL_MeshInstance *instance, SGL_Color tint) {
+    instance->tint = SGL_PackColor(tint);
+    instance->changed = true;
+}
+
 SGL_Mesh* SGL_CreateCubeMesh(SGL_Vector3 position) {
-    SGL_Vertex vertices[] = {
-        {.position = {-1.0f, 1.0f, -1.0f}},
-        {.position = {1.0f, 1.0f, -1.0f}},
-        {.position = {1.0f, -1.0f, -1.0f}},
-        {.position = {-1.0f, -1.0f, -1.0f}},
-        {.position = {-1.0f, 1.0f, 1.0f}},
-        {.position = {1.0f, 1.0f, 1.0f}},
-        {.position = {1.0f, -1.0f, 1.0f}},
-        {.position = {-1.0f, -1.0f, 1.0f}}
+    float positions[] = {
+        -1.0f, 1.0f, -1.0f,
+        1.0f, 1.0f, -1.0f,
+        1.0f, -1.0f, -1.0f,
+        -1.0f, -1.0f, -1.0f,
+        -1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f,
+        1.0f, -1.0f, 1.0f,
+        -1.0f, -1.0f, 1.0f
+    };
+
+    float_safe_index_t indices[] = {
+        0, 1, 2,
+        0, 2, 3,
+        6, 5, 4,
+        7, 6, 4,
+        5, 1, 0,
+        4, 5, 0,
+        3, 2, 6,
+        3, 6, 7,
+        3, 4, 0,
+        4, 3, 7,
+        1, 5, 6,
+        6, 2, 1
     };
 
-    SGL_Triangle triangles[] = {
-        {.vertex1 = &vertices[0], .vertex2 = &vertices[1], .vertex3 = &vertices[2], .color = SGL_BLUE},
-        {.vertex1 = &vertices[0], .vertex2 = &vertices[1], .vertex3 = &vertices[3], .color = SGL_BLUE},
-        {.vertex1 = &vertices[6], .vertex2 = &vertices[5], .vertex3 = &vertices[4], .color = SGL_BLUE},
-        {.vertex1 = &vertices[7], .vertex2 = &vertices[6], .vertex3 = &vertices[4], .color = SGL_BLUE},
-        {.vertex1 = &vertices[5], .vertex2 = &vertices[1], .vertex3 = &vertices[0], .color = SGL_RED},
-        {.vertex1 = &vertices[4], .vertex2 = &vertices[5], .vertex3 = &vertices[0], .color = SGL_RED},
-        {.vertex1 = &vertices[3], .vertex2 = &vertices[2], .vertex3 = &vertices[6], .color = SGL_RED},
-        {.vertex1 = &vertices[5], .vertex2 = &vertices[6], .vertex3 = &vertices[7], .color = SGL_RED},
-        {.vertex1 = &vertices[3], .vertex2 = &vertices[4], .vertex3 = &vertices[0], .color = SGL_GREEN},
-        {.vertex1 = &vertices[4], .vertex2 = &vertices[3], .vertex3 = &vertices[7], .color = SGL_GREEN},
-        {.vertex1 = &vertices[1], .vertex2 = &vertices[5], .vertex3 = &vertices[6], .color = SGL_GREEN},
-        {.vertex1 = &vertices[6], .vertex2 = &vertices[2], .vertex3 = &vertices[1], .color = SGL_GREEN}
+    uint32_t blue = SGL_PackColor(SGL_BLUE);
+    uint32_t red = SGL_PackColor(SGL_RED);
+    uint32_t green = SGL_PackColor(SGL_GREEN);
+
+    uint32_t colors[] = {
+        blue, blue, blue, blue,
+        red, red, red, red,
+        green, green, green, green
     };
 
-    float_safe_index_t vertices_count = sizeof(vertices) / sizeof(SGL_Vertex);
-    float_safe_index_t triangles_count = sizeof(triangles) /sizeof(SGL_Triangle);
+    float_safe_index_t vertices_count = sizeof(positions) / (sizeof(float) * 3);
+    float_safe_index_t triangles_count = sizeof(indices) / (sizeof(float_safe_index_t) * 3);
 
-    return SGL_CreateMesh(vertices, vertices_count, triangles, triangles_count, position, (SGL_Vector3){.x = 0.0f, .y = 0.0f, .z = 0.0f}, (SGL_Vector3){.x = 0.0f, .y = 0.0f, .z = 0.0f});
+    return SGL_CreateIndexedMesh(positions, vertices_count, indices, triangles_count, colors, position, (SGL_Vector3){.x = 0.0f, .y = 0.0f, .z = 0.0f}, (SGL_Vector3){.x = 1.0f, .y = 1.0f, .z = 1.0f});
 }
 
 SGL_Scene* SGL_CreateScene() {
     SGL_Scene* scene = malloc(sizeof(SGL_Scene));
     scene->meshes = SGL_CreateList();
+    scene->instances = SGL_CreateList();
     SGL_Camera *camera = malloc(sizeof(SGL_Camera));
     *camera = (SGL_Camera){
         .near = 0.1f, 
@@ -113,29 +315,11 @@ SGL_Scene* SGL_CreateScene() {
 
 void SGL_FreeScene(SGL_Scene *scene) {
     SGL_FreeList(scene->meshes, false);
+    SGL_FreeList(scene->instances, false);
     free(scene->currentCamera);
     free(scene);
 }
 
-static void multiply_matrix_with_vertex(float m[16], float_safe_index_t vertex_index, float vertices_data[]) {
-    float x = vertices_data[vertex_index];
-    float y = vertices_data[vertex_index + 1];
-    float z = vertices_data[vertex_index + 2];
-    float w = vertices_data[vertex_index + 3];
-
-    vertices_data[vertex_index] = x * m[0] + y * m[4] + z * m[8] + w * m[12];
-    vertices_data[vertex_index + 1] = x * m[1] + y * m[5] + z * m[9] + w * m[13];
-    vertices_data[vertex_index + 2] = x * m[2] + y * m[6] + z * m[10] + w * m[14];
-    vertices_data[vertex_index + 3] = x * m[3] + y * m[7] + z * m[11] + w * m[15];
-}
-
-static void multiply_matrix_with_vertices(float m[16], float vertices_data[], float_safe_index_t vertices_size) {
-    for (float_safe_index_t i = 0; i < vertices_size / VERTEX_ARRAY_SIZE; i++)
-    {
-        multiply_matrix_with_vertex(m, i * VERTEX_ARRAY_SIZE, vertices_data);
-    }
-}
-
 static void multiply_4x4_matrix(float a[16], float b[16], float out[16]) {
     for (int i = 0; i < 4; i++)
     {
@@ -275,14 +459,107 @@ struct SGL_Renderer {
     SGL_Scene *scene;
     int width;
     int height;
+    SGL_IndexMap *vertices_index_map; // Reused by cull and clip every frame
+    SGL_FrameArena *frame_arena; // Output of every pipeline stage, reset at the end of the frame
+    // Per-pixel buffers (width * height), only reallocated when the size changes
+    float *depth_buffer;
+    uint32_t *pixels; // Color buffer (ARGB8888) of offscreen renderers, they have no window or texture
+    bool is_offscreen;
+    // View projection matrix and what it was built from, only recomputed when the camera or the size changes
+    float view_projection_matrix[16];
+    SGL_Camera view_projection_camera;
+    int view_projection_width;
+    int view_projection_height;
+    bool view_projection_valid;
+    // Meshes then instances drawn in the last frame, compared with the scene's lists to detect edits
+    void **drawn_items;
+    size_t drawn_items_capacity;
+    float_safe_index_t drawn_meshes_count;
+    float_safe_index_t drawn_instances_count;
+    bool needs_redraw; // Set when the last frame can't be reused (resize, new scene, user request)
+    bool needs_present; // The window was exposed, present the last frame again even if nothing changed
+    bool presented; // The last SGL_RenderFrame call presented a frame (with vsync, it waited for the screen refresh)
+    int tile_size; // Side of the screen tiles triangles are binned into, 0 draws every triangle on the whole screen
+    int threads_count; // Threads drawing the tiles, 0 uses every logical core
+    SGL_RasterPath raster_path; // Row function of the rasterizer, SGL_RASTER_AUTO picks it from the CPU
+    SGL_ThreadPool *thread_pool; // Created on the first binned frame, NULL when drawing on one thread
+    SGL_FrameStats frame_stats;
 };
 
+/**
+ * (Re)allocates every per-pixel buffer of the renderer. Any new per-pixel buffer should be handled here
+ * so it follows the size of the texture and is never allocated during a frame.
+ */
+static bool resize_pixel_buffers(SGL_Renderer *renderer, int width, int height) {
+    SDL_aligned_free(renderer->depth_buffer);
+    renderer->depth_buffer = SDL_aligned_alloc(CACHE_LINE_SIZE, sizeof(float) * width * height);
+
+    if (!renderer->depth_buffer) {
+        SDL_Log("Depth buffer allocation failed\n");
+        return false;
+    }
+
+    if (renderer->is_offscreen) {
+        SDL_aligned_free(renderer->pixels);
+        renderer->pixels = SDL_aligned_alloc(CACHE_LINE_SIZE, sizeof(uint32_t) * width * height);
+
+        if (!renderer->pixels) {
+            SDL_Log("Pixel buffer allocation failed\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void free_pixel_buffers(SGL_Renderer *renderer) {
+    SDL_aligned_free(renderer->depth_buffer);
+    renderer->depth_buffer = NULL;
+    SDL_aligned_free(renderer->pixels);
+    renderer->pixels = NULL;
+}
+
+/**
+ * Fills count 32 bits values, also works for floats since only the bits are copied.
+ */
+static void fill_32(void *buffer, uint32_t value, size_t count) {
+    uint32_t *data = (uint32_t *)buffer;
+    size_t i = 0;
+
+#ifdef SDL_SSE2_INTRINSICS
+    // Scalar until the data is aligned on 16 bytes, then 4 values per store
+    while (i < count && ((uintptr_t)(data + i) & 15) != 0) {
+        data[i++] = value;
+    }
+
+    __m128i values = _mm_set1_epi32((int)value);
+    for (; i + 16 <= count; i += 16) {
+        _mm_store_si128((__m128i *)(data + i), values);
+        _mm_store_si128((__m128i *)(data + i + 4), values);
+        _mm_store_si128((__m128i *)(data + i + 8), values);
+        _mm_store_si128((__m128i *)(data + i + 12), values);
+    }
+    for (; i + 4 <= count; i += 4) {
+        _mm_store_si128((__m128i *)(data + i), values);
+    }
+#endif
+
+    for (; i < count; i++) {
+        data[i] = value;
+    }
+}
+
 static void free_sdl(SGL_Renderer *renderer) {
     // Free SDL memory
     SDL_DestroyTexture(renderer->texture);
     SDL_DestroyRenderer(renderer->sdl_renderer);
     SDL_DestroyWindow(renderer->window);
     SDL_Quit();
+
+    // Called again by SGL_FreeRenderer after a failure, destroying NULL does nothing
+    renderer->texture = NULL;
+    renderer->sdl_renderer = NULL;
+    renderer->window = NULL;
 }
 
 static bool resize_texture(SGL_Renderer *renderer) {
@@ -298,16 +575,55 @@ static bool resize_texture(SGL_Renderer *renderer) {
          return false;
     }
 
+    if ((new_width != renderer->width || new_height != renderer->height) && !resize_pixel_buffers(renderer, new_width, new_height)) {
+        free_sdl(renderer);
+        return false;
+    }
+
     renderer->width = new_width;
     renderer->height = new_height;
+    renderer->needs_redraw = true; // New texture, the last frame is gone
 
     return true;
 }
 
+/**
+ * Allocates a renderer with everything empty, the SDL side (or the offscreen buffer) is set up by the caller.
+ */
+static SGL_Renderer* allocate_renderer(SGL_Scene *scene) {
+    SGL_Renderer *renderer = malloc(sizeof(SGL_Renderer));
+    renderer->window = NULL;
+    renderer->is_full_screen = false;
+    renderer->sdl_renderer = NULL;
+    renderer->texture = NULL;
+    renderer->scene = scene;
+    renderer->depth_buffer = NULL;
+    renderer->pixels = NULL;
+    renderer->is_offscreen = false;
+    renderer->width = 0;
+    renderer->height = 0;
+    renderer->view_projection_valid = false;
+    renderer->drawn_items = NULL;
+    renderer->drawn_items_capacity = 0;
+    renderer->drawn_meshes_count = 0;
+    renderer->drawn_instances_count = 0;
+    renderer->needs_redraw = true;
+    renderer->needs_present = false;
+    renderer->presented = false;
+    renderer->tile_size = DEFAULT_TILE_SIZE;
+    renderer->threads_count = 0;
+    renderer->raster_path = SGL_RASTER_AUTO;
+    renderer->thread_pool = NULL;
+    renderer->vertices_index_map = NULL;
+    renderer->frame_arena = NULL;
+    memset(&renderer->frame_stats, 0, sizeof(SGL_FrameStats));
+    return renderer;
+}
+
 SGL_Renderer* SGL_CreateRenderer(const char *name, SGL_Scene *scene) {
     SDL_Init(SDL_INIT_VIDEO);
 
-    SGL_Renderer *renderer = malloc(sizeof(SGL_Renderer));
+    SGL_Renderer *renderer = allocate_renderer(scene);
 
     renderer->window = SDL_CreateWindow(
         name,
@@ -335,24 +651,156 @@ SGL_Renderer* SGL_CreateRenderer(const char *name, SGL_Scene *scene) {
         return NULL;
     }
 
-    renderer->scene = scene;
+    renderer->vertices_index_map = SGL_CreateIndexMap(0);
+    renderer->frame_arena = SGL_CreateFrameArena(0);
+
+    return renderer;
+}
+
+SGL_Renderer* SGL_CreateOffscreenRenderer(int width, int height, SGL_Scene *scene) {
+    if (width <= 0 || height <= 0) {
+        SDL_Log("Offscreen renderer creation failed: invalid size %dx%d\n", width, height);
+        return NULL;
+    }
+
+    SGL_Renderer *renderer = allocate_renderer(scene);
+    renderer->is_offscreen = true;
+
+    if (!resize_pixel_buffers(renderer, width, height)) {
+        free_pixel_buffers(renderer);
+        free(renderer);
+        return NULL;
+    }
+
+    renderer->width = width;
+    renderer->height = height;
+    renderer->vertices_index_map = SGL_CreateIndexMap(0);
+    renderer->frame_arena = SGL_CreateFrameArena(0);
 
     return renderer;
 }
 
 void SGL_FreeRenderer(SGL_Renderer *renderer) {
-    free_sdl(renderer);
+    // The workers are joined and their semaphores destroyed before SDL shuts down
+    if (renderer->thread_pool) {
+        SGL_FreeThreadPool(renderer->thread_pool);
+    }
+    SGL_FreeIndexMap(renderer->vertices_index_map);
+    SGL_FreeFrameArena(renderer->frame_arena);
+    free_pixel_buffers(renderer);
+    free(renderer->drawn_items);
+
+    if (!renderer->is_offscreen) {
+        free_sdl(renderer);
+    }
+
     free(renderer);
 }
 
 void SGL_RendererSetScene(SGL_Renderer *renderer, SGL_Scene *scene) {
     renderer->scene = scene;
+    renderer->needs_redraw = true;
+}
+
+void SGL_RendererRequestRedraw(SGL_Renderer *renderer) {
+    renderer->needs_redraw = true;
+}
+
+void SGL_RendererSetTileSize(SGL_Renderer *renderer, int tile_size) {
+    if (tile_size <= 0) {
+        renderer->tile_size = 0;
+        return;
+    }
+
+    tile_size = MIN(tile_size, MAX_TILE_SIZE);
+    renderer->tile_size = (tile_size + RASTER_SPAN - 1) / RASTER_SPAN * RASTER_SPAN;
+}
+
+void SGL_RendererSetThreadCount(SGL_Renderer *renderer, int threads_count) {
+    threads_count = MIN(MAX(threads_count, 0), MAX_THREADS_COUNT);
+    if (threads_count == renderer->threads_count) {
+        return;
+    }
+
+    // The pool is created again with the new count by the next frame
+    if (renderer->thread_pool) {
+        SGL_FreeThreadPool(renderer->thread_pool);
+        renderer->thread_pool = NULL;
+    }
+    renderer->threads_count = threads_count;
+}
+
+bool SGL_RendererSetRasterPath(SGL_Renderer *renderer, SGL_RasterPath path) {
+    bool supported = false;
+
+    switch (path) {
+        case SGL_RASTER_AUTO:
+        case SGL_RASTER_SCALAR:
+            supported = true;
+            break;
+        case SGL_RASTER_SSE2:
+#ifdef SDL_SSE2_INTRINSICS
+            supported = SDL_HasSSE2();
+#endif
+            break;
+        case SGL_RASTER_AVX2:
+#ifdef SDL_AVX2_INTRINSICS
+            supported = SDL_HasAVX2();
+#endif
+            break;
+    }
+
+    if (supported) {
+        renderer->raster_path = path;
+    }
+
+    return supported;
 }
 
 SDL_Window* SGL_RendererGetWindow(SGL_Renderer *renderer) {
     return renderer->window;
 }
 
+const uint32_t* SGL_RendererGetPixels(SGL_Renderer *renderer) {
+    return renderer->pixels;
+}
+
+const float* SGL_RendererGetDepthBuffer(SGL_Renderer *renderer) {
+    return renderer->depth_buffer;
+}
+
+bool SGL_RendererGetFrameStats(SGL_Renderer *renderer, SGL_FrameStats *out) {
+#ifdef SGL_DISABLE_FRAME_STATS
+    return false;
+#else
+    *out = renderer->frame_stats;
+    return true;
+#endif
+}
+
+const char* SGL_StageName(SGL_Stage stage) {
+    switch (stage)
+    {
+        case SGL_STAGE_FLATTEN: return "flatten";
+        case SGL_STAGE_CULL: return "cull";
+        case SGL_STAGE_CLIP: return "clip";
+        case SGL_STAGE_DIVIDE: return "divide";
+        case SGL_STAGE_VIEWPORT: return "viewport";
+        case SGL_STAGE_RASTER: return "raster";
+        case SGL_STAGE_PRESENT: return "present";
+        default: return "unknown";
+    }
+}
+
+void SGL_RendererGetSize(SGL_Renderer *renderer, int *width, int *height) {
+    *width = renderer->width;
+    *height = renderer->height;
+}
+
+size_t SGL_RendererGetFrameArenaHighWaterMark(SGL_Renderer *renderer) {
+    return SGL_FrameArenaGetHighWaterMark(renderer->frame_arena);
+}
+
 static void create_projection_matrix(SGL_Renderer *renderer, SGL_Camera *camera, float out[16]) {
     float aspectRatio = (float)renderer->width / (float)renderer->height;
 
@@ -366,138 +814,235 @@ static void create_projection_matrix(SGL_Renderer *renderer, SGL_Camera *camera,
     memcpy(out, mat, sizeof(float) * 16);
 }
 
+static bool camera_equals(const SGL_Camera *a, const SGL_Camera *b) {
+    return a->near == b->near && a->far == b->far && a->fov == b->fov &&
+           a->position.x == b->position.x && a->position.y == b->position.y && a->position.z == b->position.z &&
+           a->orientation.x == b->orientation.x && a->orientation.y == b->orientation.y && a->orientation.z == b->orientation.z;
+}
+
+/**
+ * Rebuilds renderer->view_projection_matrix only if the camera or the size of the renderer changed since the last frame.
+ * The camera is compared by value since it is modified directly by the user.
+ */
+static void update_view_projection_matrix(SGL_Renderer *renderer) {
+    SGL_Camera *camera = renderer->scene->currentCamera;
+
+    if (renderer->view_projection_valid &&
+        renderer->view_projection_width == renderer->width &&
+        renderer->view_projection_height == renderer->height &&
+        camera_equals(&renderer->view_projection_camera, camera)) {
+        return;
+    }
+
+    float view_matrix[16];
+    float projection_matrix[16];
+    create_view_matrix(camera, view_matrix);
+    create_projection_matrix(renderer, camera, projection_matrix);
+    multiply_4x4_matrix(view_matrix, projection_matrix, renderer->view_projection_matrix);
+
+    renderer->view_projection_camera = *camera;
+    renderer->view_projection_width = renderer->width;
+    renderer->view_projection_height = renderer->height;
+    renderer->view_projection_valid = true;
+}
+
+/**
+ * Copies xyz positions into xyzw vertices (w = 1) so they can be multiplied by a 4x4 matrix.
+ */
+static void positions_to_vertices(const float *positions, float_safe_index_t count, float *out_vertices) {
+    for (size_t i = 0; i < count; i++)
+    {
+        out_vertices[i * VERTEX_ARRAY_SIZE] = positions[i * 3];
+        out_vertices[i * VERTEX_ARRAY_SIZE + 1] = positions[i * 3 + 1];
+        out_vertices[i * VERTEX_ARRAY_SIZE + 2] = positions[i * 3 + 2];
+        out_vertices[i * VERTEX_ARRAY_SIZE + 3] = 1;
+    }
+}
+
+/**
+ * Multiplies each channel of a packed color by the matching channel of tint (both ARGB8888).
+ */
+static uint32_t tint_color(uint32_t color, uint32_t tint) {
+    uint32_t r = (((color >> 16) & 0xFF) * ((tint >> 16) & 0xFF) + 127) / 255;
+    uint32_t g = (((color >> 8) & 0xFF) * ((tint >> 8) & 0xFF) + 127) / 255;
+    uint32_t b = ((color & 0xFF) * (tint & 0xFF) + 127) / 255;
+
+    return (color & 0xFF000000) | (r << 16) | (g << 8) | b;
+}
+
+/**
+ * Copies the triangles of a mesh to the flat triangles array. Mesh indices are local to the mesh so they are offset
+ * by the index of the mesh's first vertex in the flat vertices array.
+ * \returns Position after the last triangle written
+ */
+static float_safe_index_t* append_triangles(const SGL_Mesh *mesh, float_safe_index_t base_vertex, uint32_t tint, float_safe_index_t *triangle_out) {
+    for (float_safe_index_t j = 0; j < mesh->triangles_count; j++)
+    {
+        const float_safe_index_t *indices = &mesh->indices[(size_t)j * 3];
+        triangle_out[0] = base_vertex + indices[0];
+        triangle_out[1] = base_vertex + indices[1];
+        triangle_out[2] = base_vertex + indices[2];
+        triangle_out[3] = tint == 0xFFFFFFFF ? mesh->colors[j] : tint_color(mesh->colors[j], tint);
+        triangle_out += TRIANGLE_ARRAY_SIZE;
+    }
+
+    return triangle_out;
+}
+
 /**
- * Local space-> world space: Converts OOP-like structure into 2 flat arrays (vertices and triangles) for faster computing in the pipeline.
- * Also converts vertices coordinates to world coordinates since all reference with meshes are lost after this. out_size is the length of the flat array,
- * NOT the amount of logical elements inside this array (aka amount of vertices/triangles)
+ * Local space-> clip space: Converts OOP-like structure into 2 flat arrays (vertices and triangles) for faster computing in the pipeline.
+ * Also converts vertices coordinates to clip coordinates since all reference with meshes are lost after this. Each mesh's
+ * transformation matrix is composed with the view projection matrix so every vertex is transformed once. Static meshes
+ * start from their cached world space vertices instead. Instances transform the geometry of their mesh with their own matrix.
+ * out_size is the length of the flat array, NOT the amount of logical elements inside this array (aka amount of vertices/triangles)
  * 
  * IMPORTANT : THE ** isnt because its an array of pointers, its a pointer of a pointer of an array (so the function can place a pointer of an array inside the pointer you gave)
  * just to clear any confusion!
- * \param meshes List of meshes to convert.
+ * \param arena Frame arena the output arrays are allocated from.
+ * \param scene Scene with the meshes and instances to convert.
+ * \param view_projection_matrix View matrix multiplied by the projection matrix.
  * \param out_vertices Pointer to the output array of vertices.
  * \param size_vertices Pointer to the size of the output vertices array.
  * \param out_triangles Pointer to the output array of triangles.
  * \param size_triangles Pointer to the size of the output triangles array.
  */
-static void convert_scene_to_flat_arrays(SGL_List *meshes, float **out_vertices, float_safe_index_t *size_vertices, float **out_triangles, float_safe_index_t *size_triangles) {
-    SGL_List *vertices = SGL_CreateList();
-    SGL_List *triangles = SGL_CreateList();
+static void convert_scene_to_flat_arrays(SGL_FrameArena *arena, SGL_Scene *scene, float view_projection_matrix[16], float **out_vertices, float_safe_index_t *size_vertices, float_safe_index_t **out_triangles, float_safe_index_t *size_triangles) {
+    SGL_List *meshes = scene->meshes;
+    SGL_List *instances = scene->instances;
+    float_safe_index_t vertices_count = 0;
+    float_safe_index_t triangles_count = 0;
 
-    // Break down all meshes data into two lists
     for (float_safe_index_t i = 0; i < meshes->size; i++)
     {
         SGL_Mesh *mesh = (SGL_Mesh*)SGL_ListGet(meshes, i);
-        create_transformation_matrix(mesh->position, mesh->orientation, mesh->scale, mesh->transformation_matrix);
-
-        for (float_safe_index_t j = 0; j < mesh->triangles->size; j++)
-        {
-            SGL_Triangle *triangle = (SGL_Triangle*)SGL_ListGet(mesh->triangles, j);
-            SGL_ListAdd(triangles, triangle);
-        }
+        vertices_count += mesh->vertices_count;
+        triangles_count += mesh->triangles_count;
+    }
 
-        for (float_safe_index_t j = 0; j < mesh->vertices->size; j++) {
-            SGL_Vertex *vertex = (SGL_Vertex*)SGL_ListGet(mesh->vertices, j);
-            SGL_ListAdd(vertices, vertex);
-        }
+    for (float_safe_index_t i = 0; i < instances->size; i++)
+    {
+        SGL_MeshInstance *instance = (SGL_MeshInstance*)SGL_ListGet(instances, i);
+        vertices_count += instance->mesh->vertices_count;
+        triangles_count += instance->mesh->triangles_count;
     }
 
-    *size_triangles = triangles->size * TRIANGLE_ARRAY_SIZE;
-    *out_triangles = malloc(sizeof(float) * (*size_triangles));
+    *size_vertices = vertices_count * VERTEX_ARRAY_SIZE;
+    *size_triangles = triangles_count * TRIANGLE_ARRAY_SIZE;
+    *out_vertices = SGL_FrameArenaAlloc(arena, sizeof(float) * (*size_vertices));
+    *out_triangles = SGL_FrameArenaAlloc(arena, sizeof(float_safe_index_t) * (*size_triangles));
 
-    for (float_safe_index_t i = 0; i < triangles->size; i++)
+    float *vertex_out = *out_vertices;
+    float_safe_index_t *triangle_out = *out_triangles;
+    float_safe_index_t base_vertex = 0; // Index of the mesh's first vertex in the flat array
+
+    for (float_safe_index_t i = 0; i < meshes->size; i++)
     {
-        SGL_Triangle *triangle = (SGL_Triangle*)SGL_ListGet(triangles, i);
-        float_safe_index_t triangle_index = i * TRIANGLE_ARRAY_SIZE;
+        SGL_Mesh *mesh = (SGL_Mesh*)SGL_ListGet(meshes, i);
+        mesh->changed = false;
 
-        (*out_triangles)[triangle_index] = SGL_ListIndexOf(vertices, triangle->vertex1) * TRIANGLE_ARRAY_SIZE;
-        (*out_triangles)[triangle_index + 1] = SGL_ListIndexOf(vertices, triangle->vertex2) * TRIANGLE_ARRAY_SIZE;
-        (*out_triangles)[triangle_index + 2] = SGL_ListIndexOf(vertices, triangle->vertex3) * TRIANGLE_ARRAY_SIZE;
-        (*out_triangles)[triangle_index + 3] = triangle->color.r;
-        (*out_triangles)[triangle_index + 4] = triangle->color.g;
-        (*out_triangles)[triangle_index + 5] = triangle->color.b;
-    }
+        if (mesh->transformation_dirty) {
+            create_transformation_matrix(mesh->position, mesh->orientation, mesh->scale, mesh->transformation_matrix);
+            mesh->transformation_dirty = false;
+            mesh->world_vertices_dirty = true;
+        }
 
-    *size_vertices = vertices->size * VERTEX_ARRAY_SIZE;
-    *out_vertices = malloc(sizeof(float) * (*size_vertices));
+        if (mesh->is_static) {
+            // Local space -> World space, only when the mesh changed
+            if (mesh->world_vertices_dirty) {
+                positions_to_vertices(mesh->positions, mesh->vertices_count, mesh->world_vertices);
+                SGL_TransformVertices(mesh->transformation_matrix, mesh->world_vertices, mesh->world_vertices, mesh->vertices_count);
+                mesh->world_vertices_dirty = false;
+            }
 
-    for (float_safe_index_t i = 0; i < vertices->size; i++)
-    {
-        SGL_Vertex *vertex = (SGL_Vertex*)SGL_ListGet(vertices, i);
-        float_safe_index_t vertex_index = i * VERTEX_ARRAY_SIZE;
+            // World space -> Clip space
+            SGL_TransformVertices(view_projection_matrix, mesh->world_vertices, vertex_out, mesh->vertices_count);
+        } else {
+            float model_view_projection_matrix[16];
+            multiply_4x4_matrix(mesh->transformation_matrix, view_projection_matrix, model_view_projection_matrix);
 
-        // Conversion from local space to world space
-        float vertex_data[] = {vertex->position.x, vertex->position.y, vertex->position.z, 1};
-        multiply_matrix_with_vertex(vertex->mesh->transformation_matrix, 0, vertex_data);
+            // Local space -> Clip space
+            positions_to_vertices(mesh->positions, mesh->vertices_count, vertex_out);
+            SGL_TransformVertices(model_view_projection_matrix, vertex_out, vertex_out, mesh->vertices_count);
+        }
 
-        (*out_vertices)[vertex_index] = vertex_data[0];
-        (*out_vertices)[vertex_index + 1] = vertex_data[1];
-        (*out_vertices)[vertex_index + 2] = vertex_data[2];
-        (*out_vertices)[vertex_index + 3] = vertex_data[3];
+        vertex_out += (size_t)mesh->vertices_count * VERTEX_ARRAY_SIZE;
+        triangle_out = append_triangles(mesh, base_vertex, 0xFFFFFFFF, triangle_out);
+        base_vertex += mesh->vertices_count;
     }
 
-    SGL_FreeList(vertices, false);
-    SGL_FreeList(triangles, false);
-}
+    for (float_safe_index_t i = 0; i < instances->size; i++)
+    {
+        SGL_MeshInstance *instance = (SGL_MeshInstance*)SGL_ListGet(instances, i);
+        SGL_Mesh *mesh = instance->mesh;
+        instance->changed = false;
+        mesh->changed = false; // Drawn through this instance, changes of the shared geometry are on screen now
+
+        if (instance->transformation_dirty) {
+            create_transformation_matrix(instance->position, instance->orientation, instance->scale, instance->transformation_matrix);
+            instance->transformation_dirty = false;
+        }
 
-static bool key_sizet_equals_function(void *a, void *b) {
-    return *(float_safe_index_t *)a == *(float_safe_index_t *)b;
-}
+        float model_view_projection_matrix[16];
+        multiply_4x4_matrix(instance->transformation_matrix, view_projection_matrix, model_view_projection_matrix);
 
-static float_safe_index_t key_sizet_hash_function(void *key) {
-    return *(float_safe_index_t *)key;
+        // Local space -> Clip space, straight from the shared geometry
+        positions_to_vertices(mesh->positions, mesh->vertices_count, vertex_out);
+        SGL_TransformVertices(model_view_projection_matrix, vertex_out, vertex_out, mesh->vertices_count);
+
+        vertex_out += (size_t)mesh->vertices_count * VERTEX_ARRAY_SIZE;
+        triangle_out = append_triangles(mesh, base_vertex, instance->tint, triangle_out);
+        base_vertex += mesh->vertices_count;
+    }
 }
 
-static float_safe_index_t add_vertex(SGL_List *vertices, SGL_HashMap *vertices_index_map, SGL_List *kept_vertices, float_safe_index_t vertices_data_index) {
-    void *found = SGL_HashMapGet(vertices_index_map, &vertices_data_index);
+/**
+ * \returns Index of the vertex in kept_vertices (copied there the first time it is seen).
+ */
+static float_safe_index_t add_vertex(const float vertices[], SGL_IndexMap *vertices_index_map, SGL_FloatBuffer *kept_vertices, float_safe_index_t vertex_index) {
+    float_safe_index_t found;
 
-    if (found == NULL) {
-        float_safe_index_t next_index = kept_vertices->size;
+    if (!SGL_IndexMapGet(vertices_index_map, vertex_index, &found)) {
+        float_safe_index_t next_index = kept_vertices->size / VERTEX_ARRAY_SIZE;
 
-        for (int i = 0; i < VERTEX_ARRAY_SIZE; i++) {
-            float *value = malloc(sizeof(float)); // Allocate new memory because new vertices array will be generated, and older array might be destroyed
-            *value = *(float*)SGL_ListGet(vertices, vertices_data_index + i);
-            SGL_ListAdd(kept_vertices, value);
-        }
+        // Copy the vertex because new vertices array will be generated, and older array might be destroyed
+        SGL_FloatBufferAddArray(kept_vertices, &vertices[(size_t)vertex_index * VERTEX_ARRAY_SIZE], VERTEX_ARRAY_SIZE);
 
         // Store the new index in the map
-        float_safe_index_t *index_ptr = malloc(sizeof(float_safe_index_t));
-        *index_ptr = next_index;
-        SGL_HashMapPut(vertices_index_map, &vertices_data_index, index_ptr);
+        SGL_IndexMapPut(vertices_index_map, vertex_index, next_index);
 
         return next_index;
     } else {
-        return *(float_safe_index_t *)found;
+        return found;
     }
 }
 
-static float_safe_index_t create_vertex(SGL_List *next_vertices, float vertex[VERTEX_ARRAY_SIZE]) {
-    float_safe_index_t next_index = next_vertices->size;
-    float *vertex_data = malloc(sizeof(float) * VERTEX_ARRAY_SIZE);
-
-    for (float_safe_index_t i = 0; i < VERTEX_ARRAY_SIZE; i++)
-    {
-        vertex_data[i] = vertex[i];
-        SGL_ListAdd(next_vertices, &vertex_data[i]);
-    }
-
+static float_safe_index_t create_vertex(SGL_FloatBuffer *next_vertices, float vertex[VERTEX_ARRAY_SIZE]) {
+    float_safe_index_t next_index = next_vertices->size / VERTEX_ARRAY_SIZE;
+    SGL_FloatBufferAddArray(next_vertices, vertex, VERTEX_ARRAY_SIZE);
     return next_index;
 }
 
-static void get_xyz(float vertices[], float_safe_index_t vertex_index, float out_xyz[3]) {
-    for (float_safe_index_t i = 0; i < 3; i++) {
-        out_xyz[i] = vertices[vertex_index + i];
-    }
+static void get_xyw(const float vertices[], float_safe_index_t vertex_index, float out_xyw[3]) {
+    size_t vertex_offset = (size_t)vertex_index * VERTEX_ARRAY_SIZE;
+    out_xyw[0] = vertices[vertex_offset];
+    out_xyw[1] = vertices[vertex_offset + 1];
+    out_xyw[2] = vertices[vertex_offset + 3];
 }
 
 /**
  * Removes the triangles and their vertices for those facing away from the camera (Triangle facing direction is defined by the order of the vertices in the triangle).
+ * Works on clip space vertices.
+ * \param vertices_index_map Scratch map reused between stages, cleared before use.
+ * \param arena Frame arena the output arrays are allocated from.
+ * \param stats Receives the amount of culled triangles (can be NULL).
  */
-static void cull(float vertices[], float_safe_index_t size_vertices, float triangles[], float_safe_index_t size_triangles, float **out_vertices, float_safe_index_t *out_size_vertices, float **out_triangles, float_safe_index_t *out_size_triangles) {
-    SGL_HashMap *vertices_index_map = SGL_CreateHashMap(key_sizet_equals_function, key_sizet_hash_function);
-    SGL_List *kept_triangles = SGL_CreateList();
-    SGL_List *kept_vertices = SGL_CreateList();
+static void cull(SGL_IndexMap *vertices_index_map, SGL_FrameArena *arena, SGL_PipelineStats *stats, float vertices[], float_safe_index_t size_vertices, float_safe_index_t triangles[], float_safe_index_t size_triangles, float **out_vertices, float_safe_index_t *out_size_vertices, float_safe_index_t **out_triangles, float_safe_index_t *out_size_triangles) {
+    SGL_IndexMapClear(vertices_index_map);
+    SGL_IndexMapReserve(vertices_index_map, size_vertices / VERTEX_ARRAY_SIZE);
 
-    SGL_List *vertices_list = SGL_CreateListFromArray(vertices, size_vertices, sizeof(float));
+    // Reserve for the case where nothing is culled so the buffers never regrow in practice
+    SGL_FloatBuffer *kept_vertices = SGL_CreateFloatBufferInArena(arena, size_vertices);
+    SGL_IndexBuffer *kept_triangles = SGL_CreateIndexBufferInArena(arena, size_triangles);
 
     for (float_safe_index_t i = 0; i < size_triangles / TRIANGLE_ARRAY_SIZE; i++)
     {
@@ -507,114 +1052,83 @@ static void cull(float vertices[], float_safe_index_t size_vertices, float trian
         float_safe_index_t vertex2_index = triangles[triangle_index + 1];
         float_safe_index_t vertex3_index = triangles[triangle_index + 2];
 
-        float vertex1_xyz[3], vertex2_xyz[3], vertex3_xyz[3];
-        get_xyz(vertices, vertex1_index, vertex1_xyz);
-        get_xyz(vertices, vertex2_index, vertex2_xyz);
-        get_xyz(vertices, vertex3_index, vertex3_xyz);
-
-        // CCW convention
-        float edge_ax = vertex2_xyz[0] - vertex1_xyz[0];
-        float edge_ay = vertex2_xyz[1] - vertex1_xyz[1];
-        float edge_az = vertex2_xyz[2] - vertex1_xyz[2];
-
-        float edge_bx = vertex3_xyz[0] - vertex1_xyz[0];
-        float edge_by = vertex3_xyz[1] - vertex1_xyz[1];
-        float edge_bz = vertex3_xyz[2] - vertex1_xyz[2];
-
-        float normal_x = (edge_ay * edge_bz) - (edge_az * edge_by);
-        float normal_y = (edge_az * edge_bx) - (edge_ax * edge_bz);
-        float normal_z = (edge_ax * edge_by) - (edge_ay * edge_bx);
-
-        float view_direction_x = vertex1_xyz[0];
-        float view_direction_y = vertex1_xyz[1];
-        float view_direction_z = vertex1_xyz[2];
-
-        float dot = (normal_x * view_direction_x) + (normal_y * view_direction_y) + (normal_z * view_direction_z);
-
-        if (dot < 0) {
-            add_vertex(vertices_list, vertices_index_map, kept_vertices, vertex1_index);
-            add_vertex(vertices_list, vertices_index_map, kept_vertices, vertex2_index);
-            add_vertex(vertices_list, vertices_index_map, kept_vertices, vertex3_index);
-
-            // Allocate each float individually for triangle color data
-            float *f3 = malloc(sizeof(float));
-            float *f4 = malloc(sizeof(float));
-            float *f5 = malloc(sizeof(float));
-            *f3 = triangles[triangle_index + 3];
-            *f4 = triangles[triangle_index + 4];
-            *f5 = triangles[triangle_index + 5];
-            SGL_ListAdd(kept_triangles, f3);
-            SGL_ListAdd(kept_triangles, f4);
-            SGL_ListAdd(kept_triangles, f5);
+        float a[3], b[3], c[3];
+        get_xyw(vertices, vertex1_index, a);
+        get_xyw(vertices, vertex2_index, b);
+        get_xyw(vertices, vertex3_index, c);
+
+        // Determinant of the clip space (x, y, w) of the vertices. The projection only scales x and y and w = -z
+        // so it is the view space (v2 - v1) x (v3 - v1) . v1 times a negative constant (backface when the dot is >= 0).
+        // Unlike a screen space winding test it stays valid for vertices behind the camera (w < 0).
+        float determinant = a[0] * (b[1] * c[2] - b[2] * c[1])
+                          - a[1] * (b[0] * c[2] - b[2] * c[0])
+                          + a[2] * (b[0] * c[1] - b[1] * c[0]);
+
+        if (determinant > 0) {
+            float_safe_index_t triangle[] = {
+                add_vertex(vertices, vertices_index_map, kept_vertices, vertex1_index),
+                add_vertex(vertices, vertices_index_map, kept_vertices, vertex2_index),
+                add_vertex(vertices, vertices_index_map, kept_vertices, vertex3_index),
+                triangles[triangle_index + 3] // Color
+            };
+
+            SGL_IndexBufferAddArray(kept_triangles, triangle, TRIANGLE_ARRAY_SIZE);
         }
     }
 
-    SGL_FreeList(vertices_list, true);
+    if (stats != NULL) {
+        stats->triangles_culled = size_triangles / TRIANGLE_ARRAY_SIZE - kept_triangles->size / TRIANGLE_ARRAY_SIZE;
+    }
 
     *out_size_vertices = kept_vertices->size;
     *out_size_triangles = kept_triangles->size;
-
-    void **vertices_ptrs = SGL_ListToArray(kept_vertices);
-    void **triangles_ptrs = SGL_ListToArray(kept_triangles);
-
-    *out_vertices = malloc(sizeof(float) * (*out_size_vertices));
-    for (float_safe_index_t i = 0; i < *out_size_vertices; i++)
-    {
-        (*out_vertices)[i] = *(float*)(vertices_ptrs[i]);
-    }
-    free(vertices_ptrs);
-
-    *out_triangles = malloc(sizeof(float) * (*out_size_triangles));
-    for (float_safe_index_t i = 0; i < *out_size_triangles; i++)
-    {
-        (*out_triangles)[i] = *(float*)(triangles_ptrs[i]);
-    }
-    free(triangles_ptrs);
-
-    SGL_FreeHashMap(vertices_index_map, true);
-    SGL_FreeList(kept_vertices, true);
-    SGL_FreeList(kept_triangles, true);
+    *out_vertices = kept_vertices->items;
+    *out_triangles = kept_triangles->items;
 }
 
-static bool planes_relation(SGL_List *active_vertices, float_safe_index_t vertex_index, int i) {
-    float w = *(float*)SGL_ListGet(active_vertices, vertex_index + 3);
+static bool planes_relation(const float active_vertices[], float_safe_index_t vertex_index, int i) {
+    const float *vertex = &active_vertices[(size_t)vertex_index * VERTEX_ARRAY_SIZE];
+    float w = vertex[3];
 
     switch (i) {
         case 0: // Left
-            return *(float*)SGL_ListGet(active_vertices, vertex_index) >= w;
+            return vertex[0] >= w;
         case 1: // Right
-            return *(float*)SGL_ListGet(active_vertices, vertex_index) <= -w;
+            return vertex[0] <= -w;
         case 2: // Top
-            return *(float*)SGL_ListGet(active_vertices, vertex_index + 1) >= w;
+            return vertex[1] >= w;
         case 3: // Bottom
-            return *(float*)SGL_ListGet(active_vertices, vertex_index + 1) <= -w;
+            return vertex[1] <= -w;
         case 4: // Near
-            return *(float*)SGL_ListGet(active_vertices, vertex_index + 2) >= w;
+            return vertex[2] >= w;
         case 5: // Far
-            return *(float*)SGL_ListGet(active_vertices, vertex_index + 2) <= -w;
+            return vertex[2] <= -w;
         default:
             return false;
     }
 }
 
-static bool get_intersection(SGL_List *active_vertices, float p1_index, float p2_index, int plane_index, float out_intersection[4]) {
+static bool get_intersection(const float active_vertices[], float_safe_index_t p1_index, float_safe_index_t p2_index, int plane_index, float out_intersection[4]) {
     float plane[4];
     memcpy(plane, planes_constants[plane_index], sizeof(float) * 4);
 
-    float x1 = *(float*)SGL_ListGet(active_vertices, p1_index);
-    float y1 = *(float*)SGL_ListGet(active_vertices, p1_index + 1);
-    float z1 = *(float*)SGL_ListGet(active_vertices, p1_index + 2);
-    float w1 = *(float*)SGL_ListGet(active_vertices, p1_index + 3);
+    const float *p1 = &active_vertices[(size_t)p1_index * VERTEX_ARRAY_SIZE];
+    const float *p2 = &active_vertices[(size_t)p2_index * VERTEX_ARRAY_SIZE];
 
-    float x2 = *(float*)SGL_ListGet(active_vertices, p2_index);
-    float y2 = *(float*)SGL_ListGet(active_vertices, p2_index + 1);
-    float z2 = *(float*)SGL_ListGet(active_vertices, p2_index + 2);
-    float w2 = *(float*)SGL_ListGet(active_vertices, p2_index + 3);
+    float x1 = p1[0];
+    float y1 = p1[1];
+    float z1 = p1[2];
+    float w1 = p1[3];
+
+    float x2 = p2[0];
+    float y2 = p2[1];
+    float z2 = p2[2];
+    float w2 = p2[3];
 
     float numerator = -(plane[0] * x1 + plane[1] * y1 + plane[2] * z1 + plane[3] * w1);
     float denominator = (plane[0] * x2 + plane[1] * y2 + plane[2] * z2 + plane[3] * w2) + numerator;
 
-    if (abs(denominator) < 1e-6f) {
+    if (fabsf(denominator) < 1e-6f) {
         return false; // Lines are parallel or coincident
     }
 
@@ -628,166 +1142,165 @@ static bool get_intersection(SGL_List *active_vertices, float p1_index, float p2
     return true;
 }
 
-static void create_new_triangle(SGL_List *active_triangles, SGL_List *next_triangles, float v1_index, float v2_index, float v3_index, float_safe_index_t og_tri_index) {
-    // Allocate and add each float individually
-    float *f0 = malloc(sizeof(float));
-    float *f1 = malloc(sizeof(float));
-    float *f2 = malloc(sizeof(float));
-    float *f3 = malloc(sizeof(float));
-    float *f4 = malloc(sizeof(float));
-    float *f5 = malloc(sizeof(float));
-
-    *f0 = v1_index;
-    *f1 = v2_index;
-    *f2 = v3_index;
-    *f3 = *(float*)SGL_ListGet(active_triangles, og_tri_index + 3);
-    *f4 = *(float*)SGL_ListGet(active_triangles, og_tri_index + 4);
-    *f5 = *(float*)SGL_ListGet(active_triangles, og_tri_index + 5);
+static void create_new_triangle(const float_safe_index_t active_triangles[], SGL_IndexBuffer *next_triangles, float_safe_index_t v1_index, float_safe_index_t v2_index, float_safe_index_t v3_index, float_safe_index_t og_tri_index) {
+    float_safe_index_t triangle[] = {
+        v1_index,
+        v2_index,
+        v3_index,
+        active_triangles[og_tri_index + 3] // Color
+    };
 
-    SGL_ListAdd(next_triangles, f0);
-    SGL_ListAdd(next_triangles, f1);
-    SGL_ListAdd(next_triangles, f2);
-    SGL_ListAdd(next_triangles, f3);
-    SGL_ListAdd(next_triangles, f4);
-    SGL_ListAdd(next_triangles, f5);
+    SGL_IndexBufferAddArray(next_triangles, triangle, TRIANGLE_ARRAY_SIZE);
 }
 
-static void clip(float vertices[], float_safe_index_t size_vertices, float triangles[], float_safe_index_t size_triangles, float **out_vertices, float_safe_index_t *out_size_vertices, float **out_triangles, float_safe_index_t *out_size_triangles) {
-    SGL_List *active_triangles = SGL_CreateListFromArray(triangles, size_triangles, sizeof(float));
-    SGL_List *active_vertices = SGL_CreateListFromArray(vertices, size_vertices, sizeof(float));
-
-    SGL_List *next_triangles = SGL_CreateList();
-    SGL_List *next_vertices = SGL_CreateList();
+/**
+ * Clips the triangles against the 6 planes of the frustum. Each plane reads from the output of the previous one,
+ * two pairs of buffers are swapped between planes so memory is only regrown when a plane produces more data than any plane before it.
+ * \param vertices_index_map Scratch map reused between stages, cleared before every plane.
+ * \param arena Frame arena the output arrays are allocated from.
+ * \param stats Receives the amount of triangles discarded, clipped and generated by every plane (can be NULL).
+ */
+static void clip(SGL_IndexMap *vertices_index_map, SGL_FrameArena *arena, SGL_PipelineStats *stats, float vertices[], float_safe_index_t size_vertices, float_safe_index_t triangles[], float_safe_index_t size_triangles, float **out_vertices, float_safe_index_t *out_size_vertices, float_safe_index_t **out_triangles, float_safe_index_t *out_size_triangles) {
+    // First plane reads the input arrays directly, no copy needed
+    const float_safe_index_t *active_triangles = triangles;
+    const float *active_vertices = vertices;
+    float_safe_index_t active_triangles_size = size_triangles;
+    float_safe_index_t active_vertices_size = size_vertices;
+
+    SGL_IndexBuffer *next_triangles = SGL_CreateIndexBufferInArena(arena, size_triangles);
+    SGL_FloatBuffer *next_vertices = SGL_CreateFloatBufferInArena(arena, size_vertices);
+    SGL_IndexBuffer *spare_triangles = SGL_CreateIndexBufferInArena(arena, size_triangles);
+    SGL_FloatBuffer *spare_vertices = SGL_CreateFloatBufferInArena(arena, size_vertices);
 
     // Iterate over each plane
     for (float_safe_index_t i = 0; i < 6; i++)
     {
-        SGL_HashMap *vertices_index_map = SGL_CreateHashMap(key_sizet_equals_function, key_sizet_hash_function);
+        SGL_IndexMapClear(vertices_index_map);
+        SGL_IndexMapReserve(vertices_index_map, active_vertices_size / VERTEX_ARRAY_SIZE);
 
-        for (float_safe_index_t j = 0; j < active_triangles->size / TRIANGLE_ARRAY_SIZE; j++)
+        Uint64 discarded = 0, clipped = 0, generated = 0;
+
+        for (float_safe_index_t j = 0; j < active_triangles_size / TRIANGLE_ARRAY_SIZE; j++)
         {
             float_safe_index_t triangle_index = j * TRIANGLE_ARRAY_SIZE;
-            float v1_index = *(float*)SGL_ListGet(active_triangles, triangle_index);
-            float v2_index = *(float*)SGL_ListGet(active_triangles, triangle_index + 1);
-            float v3_index = *(float*)SGL_ListGet(active_triangles, triangle_index + 2);
+            float_safe_index_t v1_index = active_triangles[triangle_index];
+            float_safe_index_t v2_index = active_triangles[triangle_index + 1];
+            float_safe_index_t v3_index = active_triangles[triangle_index + 2];
 
-            SGL_List *inside = SGL_CreateList();
-            SGL_List *outside = SGL_CreateList();
+            float_safe_index_t inside[3], outside[3];
+            int inside_size = 0, outside_size = 0;
 
             if (planes_relation(active_vertices, v1_index, i)) {
-                SGL_ListAdd(inside, &v1_index);
+                inside[inside_size++] = v1_index;
             } else {
-                SGL_ListAdd(outside, &v1_index);
+                outside[outside_size++] = v1_index;
             }
 
             if (planes_relation(active_vertices, v2_index, i)) {
-                SGL_ListAdd(inside, &v2_index);
+                inside[inside_size++] = v2_index;
             } else {
-                SGL_ListAdd(outside, &v2_index);
+                outside[outside_size++] = v2_index;
             }
 
             if (planes_relation(active_vertices, v3_index, i)) {
-                SGL_ListAdd(inside, &v3_index);
+                inside[inside_size++] = v3_index;
             } else {
-                SGL_ListAdd(outside, &v3_index);
+                outside[outside_size++] = v3_index;
             }
 
-            if (inside->size == 3) {
+            if (inside_size == 3) {
                 create_new_triangle(
                     active_triangles, 
                     next_triangles, 
-                    (float)add_vertex(active_vertices, vertices_index_map, next_vertices, *(float*)SGL_ListGet(inside, 0)),
-                    (float)add_vertex(active_vertices, vertices_index_map, next_vertices, *(float*)SGL_ListGet(inside, 1)),
-                    (float)add_vertex(active_vertices, vertices_index_map, next_vertices, *(float*)SGL_ListGet(inside, 2)),
+                    add_vertex(active_vertices, vertices_index_map, next_vertices, inside[0]),
+                    add_vertex(active_vertices, vertices_index_map, next_vertices, inside[1]),
+                    add_vertex(active_vertices, vertices_index_map, next_vertices, inside[2]),
                     triangle_index
                 );
-            } else if (inside->size == 2) {
+            } else if (inside_size == 2) {
+                clipped++;
+                generated++; // The part inside is a quad, split in two triangles
+
                 float intersection1[4];
                 float intersection2[4];
 
-                get_intersection(active_vertices, *(float*)SGL_ListGet(inside, 0), *(float*)SGL_ListGet(outside, 0), i, intersection1);
-                get_intersection(active_vertices, *(float*)SGL_ListGet(inside, 1), *(float*)SGL_ListGet(outside, 0), i, intersection2);
+                get_intersection(active_vertices, inside[0], outside[0], i, intersection1);
+                get_intersection(active_vertices, inside[1], outside[0], i, intersection2);
 
                 create_new_triangle(
                     active_triangles, 
                     next_triangles, 
-                    (float)add_vertex(active_vertices, vertices_index_map, next_vertices, *(float*)SGL_ListGet(inside, 0)), 
-                    (float)add_vertex(active_vertices, vertices_index_map, next_vertices, *(float*)SGL_ListGet(inside, 1)), 
-                    (float)create_vertex(next_vertices, intersection1), 
+                    add_vertex(active_vertices, vertices_index_map, next_vertices, inside[0]), 
+                    add_vertex(active_vertices, vertices_index_map, next_vertices, inside[1]), 
+                    create_vertex(next_vertices, intersection1), 
                     triangle_index
                 );
 
                 create_new_triangle(
                     active_triangles,
                     next_triangles,
-                    (float)add_vertex(active_vertices, vertices_index_map, next_vertices, *(float*)SGL_ListGet(inside, 1)),
-                    (float)create_vertex(next_vertices, intersection2),
-                    (float)create_vertex(next_vertices, intersection1),
+                    add_vertex(active_vertices, vertices_index_map, next_vertices, inside[1]),
+                    create_vertex(next_vertices, intersection2),
+                    create_vertex(next_vertices, intersection1),
                     triangle_index
                 );
-            } else if (inside->size == 1) {
+            } else if (inside_size == 1) {
+                clipped++;
+
                 float intersection1[4];
                 float intersection2[4];
 
-                get_intersection(active_vertices, *(float*)SGL_ListGet(inside, 0), *(float*)SGL_ListGet(outside, 0), i, intersection1);
-                get_intersection(active_vertices, *(float*)SGL_ListGet(inside, 0), *(float*)SGL_ListGet(outside, 1), i, intersection2);
+                get_intersection(active_vertices, inside[0], outside[0], i, intersection1);
+                get_intersection(active_vertices, inside[0], outside[1], i, intersection2);
 
                 create_new_triangle(
                     active_triangles,
                     next_triangles,
-                    (float)add_vertex(active_vertices, vertices_index_map, next_vertices, *(float*)SGL_ListGet(inside, 0)),
-                    (float)create_vertex(next_vertices, intersection2),
-                    (float)create_vertex(next_vertices, intersection1),
+                    add_vertex(active_vertices, vertices_index_map, next_vertices, inside[0]),
+                    create_vertex(next_vertices, intersection2),
+                    create_vertex(next_vertices, intersection1),
                     triangle_index
                 );
+            } else {
+                discarded++;
             }
         }
 
-        SGL_FreeHashMap(vertices_index_map, true);
-        SGL_FreeList(active_triangles, true);
-        active_triangles = next_triangles;
-        SGL_FreeList(active_vertices, true);
-        active_vertices = next_vertices;
-        next_triangles = SGL_CreateList();
-        next_vertices = SGL_CreateList();
-    }
+        if (stats != NULL) {
+            stats->triangles_discarded[i] = discarded;
+            stats->triangles_clipped[i] = clipped;
+            stats->triangles_generated[i] = generated;
+        }
 
-    *out_size_vertices = active_vertices->size;
-    *out_size_triangles = active_triangles->size;
+        // Output of this plane becomes the input of the next one, the old input buffers are recycled for the next output
+        SGL_IndexBuffer *swap_triangles = spare_triangles;
+        SGL_FloatBuffer *swap_vertices = spare_vertices;
+        spare_triangles = next_triangles;
+        spare_vertices = next_vertices;
+        next_triangles = swap_triangles;
+        next_vertices = swap_vertices;
+        SGL_IndexBufferClear(next_triangles);
+        SGL_FloatBufferClear(next_vertices);
+
+        active_triangles = spare_triangles->items;
+        active_vertices = spare_vertices->items;
+        active_triangles_size = spare_triangles->size;
+        active_vertices_size = spare_vertices->size;
+    }
 
-    void **vertices_ptrs = SGL_ListToArray(active_vertices);
-    void **triangles_ptrs = SGL_ListToArray(active_triangles);
+    *out_size_vertices = active_vertices_size;
+    *out_size_triangles = active_triangles_size;
+    *out_vertices = spare_vertices->items;
+    *out_triangles = spare_triangles->items;
+}
 
-    *out_vertices = malloc(sizeof(float) * (*out_size_vertices));
-    for (float_safe_index_t i = 0; i < *out_size_vertices; i++)
-    {
-        (*out_vertices)[i] = *(float*)(vertices_ptrs[i]);
+static bool handle_sdl_events(SGL_Renderer *renderer, SDL_Event *event) {
+    // No window to manage
+    if (renderer->is_offscreen) {
+        return event->type != SDL_EVENT_QUIT;
     }
-    free(vertices_ptrs);
 
-    *out_triangles = malloc(sizeof(float) * (*out_size_triangles));
-    for (float_safe_index_t i = 0; i < *out_size_triangles; i++)
-    {
-        (*out_triangles)[i] = *(float*)(triangles_ptrs[i]);
-    }
-    free(triangles_ptrs);
-
-    SGL_FreeList(active_triangles, true);
-    SGL_FreeList(active_vertices, true);
-    SGL_FreeList(next_triangles, true);
-    SGL_FreeList(next_vertices, true);
-}
-
-/**
- * Used at every step because the vertices and triangles are dynamically allocated.
- */
-static void free_pipeline_step(float *vertices, float *triangles) {
-    free(vertices);
-    free(triangles);
-}
-
-static bool handle_sdl_events(SGL_Renderer *renderer, SDL_Event *event) {
-    switch (event->type)
+    switch (event->type)
     {
         case SDL_EVENT_QUIT:
             return false;
@@ -796,6 +1309,9 @@ static bool handle_sdl_events(SGL_Renderer *renderer, SDL_Event *event) {
                 return false;
             }
             break;
+        case SDL_EVENT_WINDOW_EXPOSED:
+            renderer->needs_present = true;
+            break;
         case SDL_EVENT_KEY_DOWN:
             if (event->key.key == SDLK_F11) {
                 renderer->is_full_screen = !renderer->is_full_screen;
@@ -832,191 +1348,1012 @@ static void map_ndc_vertices_to_screen_coordinates(SGL_Renderer *renderer, float
     }
 }
 
-static bool point_is_in_triangle(float px, float py, float ax, float ay, float bx, float by, float cx, float cy, bool is_ccw) {
-    float edge_ab = (py - ay) * (bx - ax) - (px - ax) * (by - ay);
-    float edge_bc = (py - by) * (cx - bx) - (px - bx) * (cy - by);
-    float edge_ca = (py - cy) * (ax - cx) - (px - cx) * (ay - cy);
+/**
+ * Screen space triangle set up for rasterization. Vertices are snapped to 28.4 fixed point and pixels are sampled at
+ * their center, so edge functions are exact integers: edge i at sample (x, y) (fixed point) is
+ * (y - origin_y) * edge_x - (x - origin_x) * edge_y - bias, >= 0 inside the triangle, and grows by
+ * -edge_y * SUBPIXEL_SCALE per pixel along a row. Depth is a float plane through the first vertex, evaluated exactly at
+ * the first pixel of every span of RASTER_SPAN pixels (x multiple of RASTER_SPAN) and stepped inside it, so a pixel
+ * gets the same values wherever the walk starts (tiles, threads, SIMD).
+ */
+typedef struct {
+    int origin_x[3], origin_y[3]; // First vertex of every edge (fixed point)
+    int edge_x[3], edge_y[3]; // Second vertex - first vertex, negated for clockwise triangles so inside stays >= 0
+    int bias[3]; // 0 for top and left edges, 1 for the others so a sample exactly on an edge shared by two triangles is drawn once
+    float z, z_x, z_y; // Depth at the first vertex of the triangle (at z_x, z_y in pixels)
+    float z_dx, z_dy; // Depth change per pixel along x and y
+    int min_x, min_y, max_x, max_y; // Pixels whose center can be inside the triangle, clamped to the screen, max excluded
+    bool is_small; // At most SMALL_TRIANGLE_SIZE pixels on both sides, drawn one candidate pixel at a time
+    uint32_t color;
+} triangle_setup;
+
+// Work counted by the rasterizer for the pipeline statistics
+typedef struct {
+    Uint64 pixels_tested;
+    Uint64 depth_passed;
+    Uint64 depth_failed;
+} raster_counters;
+
+// Exact value of edge i at the center of pixel (x, y)
+static inline Sint64 edge_at(const triangle_setup *triangle, int i, int x, int y) {
+    Sint64 sample_x = (Sint64)x * SUBPIXEL_SCALE + SUBPIXEL_SCALE / 2;
+    Sint64 sample_y = (Sint64)y * SUBPIXEL_SCALE + SUBPIXEL_SCALE / 2;
+
+    return (sample_y - triangle->origin_y[i]) * triangle->edge_x[i] - (sample_x - triangle->origin_x[i]) * triangle->edge_y[i] - triangle->bias[i];
+}
+
+/**
+ * Computes the edge functions, bounding box and depth plane of a triangle.
+ * \returns false if the triangle has no area once snapped or covers no pixel center of the screen (nothing to draw)
+ */
+static bool setup_triangle(const float *v1, const float *v2, const float *v3, uint32_t color, int width, int height, triangle_setup *out) {
+    const float *vertices[3] = {v1, v2, v3};
+    int x[3], y[3];
+
+    // Clipping keeps the vertices on the screen so they easily fit in 28.4
+    for (int i = 0; i < 3; i++)
+    {
+        x[i] = (int)lrintf(vertices[i][0] * SUBPIXEL_SCALE);
+        y[i] = (int)lrintf(vertices[i][1] * SUBPIXEL_SCALE);
+    }
+
+    Sint64 signed_area = (Sint64)(x[1] - x[0]) * (y[2] - y[0]) - (Sint64)(y[1] - y[0]) * (x[2] - x[0]);
+    if (signed_area == 0) {
+        return false;
+    }
+
+    int sign = signed_area > 0 ? 1 : -1;
+
+    for (int i = 0; i < 3; i++)
+    {
+        int next = (i + 1) % 3;
+
+        out->origin_x[i] = x[i];
+        out->origin_y[i] = y[i];
+        out->edge_x[i] = (x[next] - x[i]) * sign;
+        out->edge_y[i] = (y[next] - y[i]) * sign;
+
+        // With y going down, inside on the >= 0 side: left edges go up, top edges are horizontal and go right
+        bool is_top_left = out->edge_y[i] < 0 || (out->edge_y[i] == 0 && out->edge_x[i] > 0);
+        out->bias[i] = is_top_left ? 0 : 1;
+    }
+
+    // Pixel x has its center at x + 0.5, so it can be covered from x = ceil(min - 0.5) to floor(max - 0.5) included
+    int min_x = MAX(MIN(MIN(x[0], x[1]), x[2]), 0);
+    int max_x = MAX(MAX(MAX(x[0], x[1]), x[2]), 0);
+    int min_y = MAX(MIN(MIN(y[0], y[1]), y[2]), 0);
+    int max_y = MAX(MAX(MAX(y[0], y[1]), y[2]), 0);
+    int half = SUBPIXEL_SCALE / 2;
+
+    out->min_x = (min_x - half + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS;
+    out->max_x = MIN((max_x - half + SUBPIXEL_SCALE) >> SUBPIXEL_BITS, width);
+    out->min_y = (min_y - half + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS;
+    out->max_y = MIN((max_y - half + SUBPIXEL_SCALE) >> SUBPIXEL_BITS, height);
+    out->color = color;
+
+    if (out->min_x >= out->max_x || out->min_y >= out->max_y) {
+        return false;
+    }
+
+    // Dense meshes make lots of triangles around a pixel big, most of them between the pixel centers: their few
+    // candidate centers are tested now so they're dropped before the depth plane and binning
+    out->is_small = out->max_x - out->min_x <= SMALL_TRIANGLE_SIZE && out->max_y - out->min_y <= SMALL_TRIANGLE_SIZE;
+    if (out->is_small) {
+        bool covers_sample = false;
+
+        for (int sample_y = out->min_y; sample_y < out->max_y && !covers_sample; sample_y++)
+        {
+            for (int sample_x = out->min_x; sample_x < out->max_x && !covers_sample; sample_x++)
+            {
+                covers_sample = edge_at(out, 0, sample_x, sample_y) >= 0 && edge_at(out, 1, sample_x, sample_y) >= 0 && edge_at(out, 2, sample_x, sample_y) >= 0;
+            }
+        }
+
+        if (!covers_sample) {
+            return false;
+        }
+    }
+
+    // Depth plane through the snapped vertices so it matches the edges
+    float scale = 1.0f / SUBPIXEL_SCALE;
+    float x1 = x[0] * scale, y1 = y[0] * scale;
+    float x2 = x[1] * scale, y2 = y[1] * scale;
+    float x3 = x[2] * scale, y3 = y[2] * scale;
+    float area = (float)signed_area * scale * scale;
+
+    out->z = v1[2];
+    out->z_x = x1;
+    out->z_y = y1;
+    out->z_dx = ((v2[2] - v1[2]) * (y3 - y1) - (v3[2] - v1[2]) * (y2 - y1)) / area;
+    out->z_dy = ((v3[2] - v1[2]) * (x2 - x1) - (v2[2] - v1[2]) * (x3 - x1)) / area;
+
+    return true;
+}
+
+// Values of a triangle shared by all the rows drawn in a rectangle
+typedef struct {
+    // Offsets of the edges and depth from the first pixel of a span, added to the exact values at the start of the span
+    int32_t edge[3][RASTER_SPAN];
+    float z[RASTER_SPAN];
+    // Right side of the rectangle (excluded). Rectangles are made of whole spans up to the end of the row, so the
+    // pixels of a span before it are only drawn by this thread and can be rewritten with their own value.
+    int rect_max_x;
+} span_offsets;
 
-    if (!is_ccw) {
-        edge_ab *= -1;
-        edge_bc *= -1;
-        edge_ca *= -1;
+/**
+ * Draws the pixels min_x to max_x (excluded) of row y covered by a triangle. Every version evaluates the same span
+ * start values and adds the same offsets, so they give the same images, only the amount of pixels per step changes.
+ * \param inside true if every pixel from min_x to max_x is known to be covered, only the depth test is done
+ * \param depth_passed, depth_failed Incremented with the amount of covered pixels passing and failing the depth test
+ */
+typedef void (*raster_row_function)(const triangle_setup *triangle, const span_offsets *offsets, int y, int min_x, int max_x, bool inside, uint32_t *pixel_row, float *depth_row, Uint64 *depth_passed, Uint64 *depth_failed);
+
+/**
+ * Edge and depth values at the center of the first pixel of a span. Depth is evaluated from the plane so rounding
+ * errors never add up along a row and a pixel has the same values whatever the rectangle it is drawn in. Edges are
+ * exact in 64 bits then clamped to 32 bits: a span only moves them by less than 2^24 so the signs inside it don't change.
+ * \param edges NULL to only compute the depth (span inside the triangle)
+ */
+static inline void span_start(const triangle_setup *triangle, int y, int span_x, int32_t edges[3], float *z) {
+    if (edges != NULL) {
+        for (int i = 0; i < 3; i++)
+        {
+            Sint64 edge = edge_at(triangle, i, span_x, y);
+            edges[i] = (int32_t)MIN(MAX(edge, -EDGE_CLAMP), EDGE_CLAMP);
+        }
     }
 
-    return (edge_ab >= 0) && (edge_bc >= 0) && (edge_ca >= 0);
+    float center_x = (float)span_x + 0.5f;
+    float center_y = (float)y + 0.5f;
+    *z = triangle->z + (center_x - triangle->z_x) * triangle->z_dx + (center_y - triangle->z_y) * triangle->z_dy;
 }
 
-static bool is_triangle_ccw(float ax, float ay, float bx, float by, float cx, float cy) {
-    float signed_area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
-    return signed_area > 0;
+// Amount of bits set in a coverage mask (at most RASTER_SPAN bits)
+static inline int mask_count(int mask) {
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        count++;
+    }
+    return count;
 }
 
-static bool render_triangles(SGL_Renderer *renderer, float vertices[], float_safe_index_t vertices_size, float triangles[], float_safe_index_t triangles_size) {
-    void *pixels;
-    int pitch;
+static void raster_row_scalar(const triangle_setup *triangle, const span_offsets *offsets, int y, int min_x, int max_x, bool inside, uint32_t *pixel_row, float *depth_row, Uint64 *depth_passed, Uint64 *depth_failed) {
+    uint32_t color = triangle->color;
+    Uint64 passed = 0, failed = 0;
 
-    if (!SDL_LockTexture(renderer->texture, NULL, &pixels, &pitch)) {
-        SDL_Log("Failed to lock texture: %s\n", SDL_GetError());
-        free_sdl(renderer);
-        return false;
+    for (int span_x = min_x & ~(RASTER_SPAN - 1); span_x < max_x; span_x += RASTER_SPAN)
+    {
+        int32_t edges[3] = {0, 0, 0};
+        float z;
+        span_start(triangle, y, span_x, inside ? NULL : edges, &z);
+
+        int first = MAX(span_x, min_x) - span_x;
+        int last = MIN(span_x + RASTER_SPAN, max_x) - span_x;
+
+        for (int k = first; k < last; k++)
+        {
+            if (inside || (edges[0] + offsets->edge[0][k] >= 0 && edges[1] + offsets->edge[1][k] >= 0 && edges[2] + offsets->edge[2][k] >= 0)) {
+                float pixel_z = z + offsets->z[k];
+                int x = span_x + k;
+
+                if (pixel_z < depth_row[x]) {
+                    depth_row[x] = pixel_z;
+                    pixel_row[x] = color;
+                    passed++;
+                } else {
+                    failed++;
+                }
+            }
+        }
     }
 
-    // Use example
+    *depth_passed += passed;
+    *depth_failed += failed;
+}
 
-    //IMPORTANT: ARGB format, use pitch instead of SDL renderer width for getting the index of the pixel in the buffer.
-    uint32_t *buffer = (uint32_t *)pixels;
+#ifdef SDL_SSE2_INTRINSICS
+/**
+ * Two groups of 4 pixels per span. SSE2 has no masked store, so a group is loaded, blended with the pixels passing
+ * the depth test and stored back whole. Only the last group of a row cut by the end of the rectangle is done like
+ * the scalar version, the pixels after it can be past the end of the row or drawn by another thread.
+ */
+static void SDL_TARGETING("sse2") raster_row_sse2(const triangle_setup *triangle, const span_offsets *offsets, int y, int min_x, int max_x, bool inside, uint32_t *pixel_row, float *depth_row, Uint64 *depth_passed, Uint64 *depth_failed) {
+    uint32_t color = triangle->color;
+    __m128i colors = _mm_set1_epi32((int)color);
+    __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i minus_one = _mm_set1_epi32(-1);
+    Uint64 passed = 0, failed = 0;
+
+    for (int span_x = min_x & ~(RASTER_SPAN - 1); span_x < max_x; span_x += RASTER_SPAN)
+    {
+        int32_t edges[3] = {0, 0, 0};
+        float z;
+        span_start(triangle, y, span_x, inside ? NULL : edges, &z);
+
+        int first = MAX(span_x, min_x) - span_x;
+        int last = MIN(span_x + RASTER_SPAN, max_x) - span_x;
 
-    // Clear to black manually
-    for (int y = 0; y < renderer->height; y++) {
-        for (int x = 0; x < renderer->width; x++) {
-            buffer[y * (pitch / sizeof(uint32_t)) + x] = 0xFF000000;
+        for (int k0 = 0; k0 < RASTER_SPAN; k0 += 4)
+        {
+            if (k0 + 4 <= first || k0 >= last) {
+                continue;
+            }
+
+            if (span_x + k0 + 4 > offsets->rect_max_x) {
+                for (int k = MAX(k0, first); k < MIN(k0 + 4, last); k++)
+                {
+                    if (inside || (edges[0] + offsets->edge[0][k] >= 0 && edges[1] + offsets->edge[1][k] >= 0 && edges[2] + offsets->edge[2][k] >= 0)) {
+                        float pixel_z = z + offsets->z[k];
+                        int x = span_x + k;
+
+                        if (pixel_z < depth_row[x]) {
+                            depth_row[x] = pixel_z;
+                            pixel_row[x] = color;
+                            passed++;
+                        } else {
+                            failed++;
+                        }
+                    }
+                }
+                continue;
+            }
+
+            __m128i covered_bits = minus_one;
+            if (!inside) {
+                // edge > -1 for the 3 edges
+                covered_bits = _mm_cmpgt_epi32(_mm_add_epi32(_mm_set1_epi32(edges[0]), _mm_loadu_si128((const __m128i *)&offsets->edge[0][k0])), minus_one);
+                covered_bits = _mm_and_si128(covered_bits, _mm_cmpgt_epi32(_mm_add_epi32(_mm_set1_epi32(edges[1]), _mm_loadu_si128((const __m128i *)&offsets->edge[1][k0])), minus_one));
+                covered_bits = _mm_and_si128(covered_bits, _mm_cmpgt_epi32(_mm_add_epi32(_mm_set1_epi32(edges[2]), _mm_loadu_si128((const __m128i *)&offsets->edge[2][k0])), minus_one));
+            }
+            if (k0 < first || k0 + 4 > last) {
+                // lanes >= first and lanes < last
+                __m128i group_lanes = _mm_add_epi32(lanes, _mm_set1_epi32(k0));
+                __m128i in_range = _mm_andnot_si128(_mm_cmpgt_epi32(_mm_set1_epi32(first), group_lanes), _mm_cmpgt_epi32(_mm_set1_epi32(last), group_lanes));
+                covered_bits = _mm_and_si128(covered_bits, in_range);
+            }
+            __m128 covered = _mm_castsi128_ps(covered_bits);
+
+            int covered_mask = _mm_movemask_ps(covered);
+            if (covered_mask == 0) {
+                continue;
+            }
+
+            float *depth = depth_row + span_x + k0;
+            uint32_t *pixel = pixel_row + span_x + k0;
+            __m128 pixel_z = _mm_add_ps(_mm_set1_ps(z), _mm_loadu_ps(&offsets->z[k0]));
+            __m128 old_z = _mm_loadu_ps(depth);
+            __m128 pass = _mm_and_ps(covered, _mm_cmplt_ps(pixel_z, old_z));
+
+            int pass_mask = _mm_movemask_ps(pass);
+            int pass_count = mask_count(pass_mask);
+            passed += pass_count;
+            failed += mask_count(covered_mask) - pass_count;
+
+            if (pass_mask != 0) {
+                __m128i pass_bits = _mm_castps_si128(pass);
+                _mm_storeu_ps(depth, _mm_or_ps(_mm_and_ps(pass, pixel_z), _mm_andnot_ps(pass, old_z)));
+                __m128i old_pixels = _mm_loadu_si128((const __m128i *)pixel);
+                _mm_storeu_si128((__m128i *)pixel, _mm_or_si128(_mm_and_si128(pass_bits, colors), _mm_andnot_si128(pass_bits, old_pixels)));
+            }
         }
     }
 
-    int depth_buffer_size = renderer->width * renderer->height;
-    float depth_buffer[depth_buffer_size];
+    *depth_passed += passed;
+    *depth_failed += failed;
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+/**
+ * One span per step. The pixels outside min_x and max_x are removed from the mask, and the depth is read and both
+ * buffers are written with masked loads and stores, so the pixels not covered are never touched.
+ */
+static void SDL_TARGETING("avx2") raster_row_avx2(const triangle_setup *triangle, const span_offsets *offsets, int y, int min_x, int max_x, bool inside, uint32_t *pixel_row, float *depth_row, Uint64 *depth_passed, Uint64 *depth_failed) {
+    __m256i edge_offsets0 = _mm256_loadu_si256((const __m256i *)offsets->edge[0]);
+    __m256i edge_offsets1 = _mm256_loadu_si256((const __m256i *)offsets->edge[1]);
+    __m256i edge_offsets2 = _mm256_loadu_si256((const __m256i *)offsets->edge[2]);
+    __m256 z_offsets = _mm256_loadu_ps(offsets->z);
+    __m256i colors = _mm256_set1_epi32((int)triangle->color);
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i minus_one = _mm256_set1_epi32(-1);
+    Uint64 passed = 0, failed = 0;
+
+    for (int span_x = min_x & ~(RASTER_SPAN - 1); span_x < max_x; span_x += RASTER_SPAN)
+    {
+        int32_t edges[3];
+        float z;
+        __m256i covered_bits = minus_one;
+
+        if (inside) {
+            span_start(triangle, y, span_x, NULL, &z);
+        } else {
+            span_start(triangle, y, span_x, edges, &z);
+
+            // edge > -1 for the 3 edges
+            covered_bits = _mm256_cmpgt_epi32(_mm256_add_epi32(_mm256_set1_epi32(edges[0]), edge_offsets0), minus_one);
+            covered_bits = _mm256_and_si256(covered_bits, _mm256_cmpgt_epi32(_mm256_add_epi32(_mm256_set1_epi32(edges[1]), edge_offsets1), minus_one));
+            covered_bits = _mm256_and_si256(covered_bits, _mm256_cmpgt_epi32(_mm256_add_epi32(_mm256_set1_epi32(edges[2]), edge_offsets2), minus_one));
+        }
+        __m256 covered = _mm256_castsi256_ps(covered_bits);
+
+        int first = MAX(span_x, min_x) - span_x;
+        int last = MIN(span_x + RASTER_SPAN, max_x) - span_x;
+        if (first > 0 || last < RASTER_SPAN) {
+            // lanes >= first and lanes < last
+            __m256i in_range = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(first), lanes), _mm256_cmpgt_epi32(_mm256_set1_epi32(last), lanes));
+            covered = _mm256_and_ps(covered, _mm256_castsi256_ps(in_range));
+        }
+
+        int covered_mask = _mm256_movemask_ps(covered);
+        if (covered_mask == 0) {
+            continue;
+        }
+
+        float *depth = depth_row + span_x;
+        __m256 pixel_z = _mm256_add_ps(_mm256_set1_ps(z), z_offsets);
+        __m256 old_z = _mm256_maskload_ps(depth, _mm256_castps_si256(covered));
+        __m256 pass = _mm256_and_ps(covered, _mm256_cmp_ps(pixel_z, old_z, _CMP_LT_OQ));
 
-    for (int i = 0; i < depth_buffer_size; i++) {
-        depth_buffer[i] = FLT_MAX;
+        int pass_mask = _mm256_movemask_ps(pass);
+        int pass_count = mask_count(pass_mask);
+        passed += pass_count;
+        failed += mask_count(covered_mask) - pass_count;
+
+        if (pass_mask != 0) {
+            __m256i pass_bits = _mm256_castps_si256(pass);
+            _mm256_maskstore_ps(depth, pass_bits, pixel_z);
+            _mm256_maskstore_epi32((int *)(pixel_row + span_x), pass_bits, colors);
+        }
     }
 
-    for (float_safe_index_t i = 0; i < triangles_size / TRIANGLE_ARRAY_SIZE; i++) {
-        float_safe_index_t triangle_index = i * TRIANGLE_ARRAY_SIZE;
+    *depth_passed += passed;
+    *depth_failed += failed;
+}
+#endif
 
-        int v1_index = (int)triangles[triangle_index];
-        int v2_index = (int)triangles[triangle_index + 1];
-        int v3_index = (int)triangles[triangle_index + 2];
+static raster_row_function select_raster_row_function(void) {
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) return raster_row_avx2;
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) return raster_row_sse2;
+#endif
+    return raster_row_scalar;
+}
 
-        float v1_x = vertices[v1_index];
-        float v1_y = vertices[v1_index + 1];
+/**
+ * \returns The row function of a path, supported paths are checked by SGL_RendererSetRasterPath.
+ */
+static raster_row_function get_raster_row_function(SGL_RasterPath path) {
+    // Every thread would pick the same function so racing on the first call is harmless
+    static raster_row_function fastest = NULL;
 
-        float v2_x = vertices[v2_index];
-        float v2_y = vertices[v2_index + 1];
+    switch (path) {
+#ifdef SDL_SSE2_INTRINSICS
+        case SGL_RASTER_SSE2: return raster_row_sse2;
+#endif
+#ifdef SDL_AVX2_INTRINSICS
+        case SGL_RASTER_AVX2: return raster_row_avx2;
+#endif
+        case SGL_RASTER_SCALAR: return raster_row_scalar;
+        default: break;
+    }
 
-        float v3_x = vertices[v3_index];
-        float v3_y = vertices[v3_index + 1];
+    if (fastest == NULL) {
+        fastest = select_raster_row_function();
+    }
 
-        bool is_ccw = is_triangle_ccw(v1_x, v1_y, v2_x, v2_y, v3_x, v3_y);
+    return fastest;
+}
 
-        float min_x = floor(MIN(MIN(v1_x, v2_x), v3_x));
-        float max_x = floor(MAX(MAX(v1_x, v2_x), v3_x));
-        float min_y = floor(MIN(MIN(v1_y, v2_y), v3_y));
-        float max_y = floor(MAX(MAX(v1_y, v2_y), v3_y));
+typedef enum {
+    BLOCK_OUTSIDE, // No pixel covered
+    BLOCK_PARTIAL, // Pixels must be tested one by one
+    BLOCK_INSIDE // Every pixel covered
+} block_coverage;
 
-        for (float y = min_y; y < max_y; y++) {
-            for (float x = min_x; x < max_x; x++) {
-                if (point_is_in_triangle(x, y, v1_x, v1_y, v2_x, v2_y, v3_x, v3_y, is_ccw)) {
-                    float v1_z = vertices[v1_index + 2];
-                    float v2_z = vertices[v2_index + 2];
-                    float v3_z = vertices[v3_index + 2];
+/**
+ * Tests the pixels min_x to max_x and min_y to max_y (excluded) against the edges of a triangle at once. Edges are
+ * linear so their smallest and largest values in the block are at its corners, computed exactly like the pixels.
+ */
+static block_coverage classify_block(const triangle_setup *triangle, int min_x, int min_y, int max_x, int max_y) {
+    block_coverage coverage = BLOCK_INSIDE;
 
-                    // Computer barycentric coordinates (a1, a2, a3)
-                    float denominator = (v2_y - v3_y) * (v1_x - v3_x) + (v3_x - v2_x) * (v1_y - v3_y);
+    for (int i = 0; i < 3; i++)
+    {
+        Sint64 corner = edge_at(triangle, i, min_x, min_y);
+        Sint64 step_x = (Sint64)-triangle->edge_y[i] * SUBPIXEL_SCALE * (max_x - 1 - min_x);
+        Sint64 step_y = (Sint64)triangle->edge_x[i] * SUBPIXEL_SCALE * (max_y - 1 - min_y);
+        Sint64 lowest = corner + MIN(step_x, 0) + MIN(step_y, 0);
+        Sint64 highest = corner + MAX(step_x, 0) + MAX(step_y, 0);
+
+        if (highest < 0) {
+            return BLOCK_OUTSIDE;
+        }
+        if (lowest < 0) {
+            coverage = BLOCK_PARTIAL;
+        }
+    }
 
-                    float a1 = ((v2_y - v3_y) * (x - v3_x) + (v3_x - v2_x) * (y - v3_y)) / denominator;
-                    float a2 = ((v3_y - v1_y) * (x - v3_x) + (v1_x - v3_x) * (y - v3_y)) / denominator;
-                    float a3 = 1 - a1 - a2;
+    return coverage;
+}
 
-                    // Interpolate z value using barycentric coordinates
-                    float z = a1 * v1_z + a2 * v2_z + a3 * v3_z;
+/**
+ * Draws a small triangle (is_small) clipped to a rectangle: its 1 to 4 candidate pixels are tested alone, without the
+ * span offsets, blocks and row function of bigger triangles. Depth is computed the same way as in a span so the
+ * pixels get the same values as with the other paths.
+ */
+static void rasterize_small_triangle(const triangle_setup *triangle, int min_x, int min_y, int max_x, int max_y, uint32_t *pixels, int pitch, float *depth_buffer, int width, raster_counters *counters) {
+    for (int y = min_y; y < max_y; y++)
+    {
+        uint32_t *pixel_row = pixels + (size_t)y * pitch;
+        float *depth_row = depth_buffer + (size_t)y * width;
 
-                    int depth_index = (y * renderer->width + x);
-                    if (z < depth_buffer[depth_index]) {
-                        depth_buffer[depth_index] = z;
+        for (int x = min_x; x < max_x; x++)
+        {
+            if (edge_at(triangle, 0, x, y) < 0 || edge_at(triangle, 1, x, y) < 0 || edge_at(triangle, 2, x, y) < 0) {
+                continue;
+            }
 
-                        int pixel_index = (y * (pitch / sizeof(uint32_t)) + x);
+            int span_x = x & ~(RASTER_SPAN - 1);
+            float z;
+            span_start(triangle, y, span_x, NULL, &z);
+            z += (float)(x - span_x) * triangle->z_dx;
 
-                        /*
-                        uint8_t r = (uint8_t)triangles[triangle_index + 3];
-                        uint8_t g = (uint8_t)triangles[triangle_index + 4];
-                        uint8_t b = (uint8_t)triangles[triangle_index + 5];
+            if (z < depth_row[x]) {
+                depth_row[x] = z;
+                pixel_row[x] = triangle->color;
+                counters->depth_passed++;
+            } else {
+                counters->depth_failed++;
+            }
+        }
+    }
 
-                        uint32_t color = (0xFF << 24) | (r << 16) | (g << 8) | b;
-                        */
+    counters->pixels_tested += (Uint64)(max_x - min_x) * (Uint64)(max_y - min_y);
+}
 
-                        buffer[pixel_index] = 0xFFFFFF;
-                    }
-                }
+/**
+ * Draws the part of a set up triangle inside a rectangle: covered pixels closer than the depth buffer are written
+ * in both buffers, with the row function of the renderer's raster path. The rectangle is walked in blocks of
+ * RASTER_BLOCK x RASTER_BLOCK pixels, blocks outside the triangle are skipped and blocks inside it skip the edge tests,
+ * so long thin triangles only test the pixels along their edges.
+ * \param pitch Pixels per row of the color buffer (the depth buffer has width pixels per row)
+ * \param min_x, min_y, max_x, max_y Rectangle to draw in (max excluded), the screen or a tile
+ */
+static void rasterize_triangle(const triangle_setup *triangle, raster_row_function raster_row, int min_x, int min_y, int max_x, int max_y, uint32_t *pixels, int pitch, float *depth_buffer, int width, raster_counters *counters) {
+    int rect_max_x = max_x;
+    min_x = MAX(min_x, triangle->min_x);
+    min_y = MAX(min_y, triangle->min_y);
+    max_x = MIN(max_x, triangle->max_x);
+    max_y = MIN(max_y, triangle->max_y);
+
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+
+    if (triangle->is_small) {
+        rasterize_small_triangle(triangle, min_x, min_y, max_x, max_y, pixels, pitch, depth_buffer, width, counters);
+        return;
+    }
+
+    span_offsets offsets;
+    for (int k = 0; k < RASTER_SPAN; k++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            offsets.edge[i][k] = k * -triangle->edge_y[i] * SUBPIXEL_SCALE;
+        }
+        offsets.z[k] = (float)k * triangle->z_dx;
+    }
+    offsets.rect_max_x = rect_max_x;
+
+    // Blocks are aligned on the screen like spans, tiles are made of whole blocks
+    for (int block_y = min_y & ~(RASTER_BLOCK - 1); block_y < max_y; block_y += RASTER_BLOCK)
+    {
+        int block_min_y = MAX(block_y, min_y);
+        int block_max_y = MIN(block_y + RASTER_BLOCK, max_y);
+
+        for (int block_x = min_x & ~(RASTER_BLOCK - 1); block_x < max_x; block_x += RASTER_BLOCK)
+        {
+            int block_min_x = MAX(block_x, min_x);
+            int block_max_x = MIN(block_x + RASTER_BLOCK, max_x);
+
+            block_coverage coverage = classify_block(triangle, block_min_x, block_min_y, block_max_x, block_max_y);
+            if (coverage == BLOCK_OUTSIDE) {
+                continue;
+            }
+
+            bool inside = coverage == BLOCK_INSIDE;
+            if (!inside) {
+                counters->pixels_tested += (Uint64)(block_max_x - block_min_x) * (Uint64)(block_max_y - block_min_y);
+            }
+
+            for (int y = block_min_y; y < block_max_y; y++)
+            {
+                raster_row(triangle, &offsets, y, block_min_x, block_max_x, inside, pixels + (size_t)y * pitch, depth_buffer + (size_t)y * width, &counters->depth_passed, &counters->depth_failed);
             }
         }
     }
+}
 
-    SDL_UnlockTexture(renderer->texture);
-    SDL_RenderTexture(renderer->sdl_renderer, renderer->texture, NULL, NULL);
-    SDL_RenderPresent(renderer->sdl_renderer);
+/**
+ * Clears a rectangle of the color (to black) and depth (to FLT_MAX) buffers.
+ */
+static void clear_rect(uint32_t *pixels, int pitch, float *depth_buffer, int width, int min_x, int min_y, int max_x, int max_y) {
+    uint32_t far_depth;
+    float max_depth = FLT_MAX;
+    memcpy(&far_depth, &max_depth, sizeof(float));
 
-    return true;
+    for (int y = min_y; y < max_y; y++)
+    {
+        fill_32(pixels + (size_t)y * pitch + min_x, 0xFF000000, max_x - min_x);
+        fill_32(depth_buffer + (size_t)y * width + min_x, far_depth, max_x - min_x);
+    }
 }
 
-static void stage_debug_print(char *space, float_safe_index_t vertices_size, float_safe_index_t triangles_size, float *vertices, float *triangles) {
-    if (vertices_size != 0 || triangles_size != 0) {
-        printf("(%s) Vertices: %" PRIu32 ", Triangles: %" PRIu32 "\n\n", space, vertices_size / VERTEX_ARRAY_SIZE, triangles_size / TRIANGLE_ARRAY_SIZE);
+/**
+ * Sorts the set up triangles into the tiles their bounding box overlaps with a counting sort (count per tile, prefix
+ * sum, scatter) so the bins are two flat arrays from the frame arena. Bins keep the order of the triangles, so a tile
+ * draws them in the same order as the whole screen would.
+ * \param out_bin_offsets Bin of tile t is out_bins[out_bin_offsets[t]] to out_bins[out_bin_offsets[t + 1]] (excluded)
+ * \param out_bins Indices of the triangles in setups
+ */
+static void bin_triangles(SGL_FrameArena *arena, const triangle_setup *setups, float_safe_index_t setups_count, int tile_size, int tiles_x, int tiles_y, float_safe_index_t **out_bin_offsets, float_safe_index_t **out_bins) {
+    int tiles_count = tiles_x * tiles_y;
+    float_safe_index_t *bin_offsets = SGL_FrameArenaAlloc(arena, sizeof(float_safe_index_t) * (tiles_count + 1));
+    float_safe_index_t *cursors = SGL_FrameArenaAlloc(arena, sizeof(float_safe_index_t) * tiles_count);
+    memset(cursors, 0, sizeof(float_safe_index_t) * tiles_count);
 
-        printf("Vertices: \n\n");
-        for (float_safe_index_t i = 0; i < vertices_size / VERTEX_ARRAY_SIZE; i++)
+    for (float_safe_index_t i = 0; i < setups_count; i++)
+    {
+        const triangle_setup *triangle = &setups[i];
+
+        for (int tile_y = triangle->min_y / tile_size; tile_y <= (triangle->max_y - 1) / tile_size; tile_y++)
         {
-            float_safe_index_t vertex_index = i * VERTEX_ARRAY_SIZE;
-            printf("%" PRIu32 " - x: %f, y: %f, z: %f, w: %f\n", i, vertices[vertex_index], vertices[vertex_index + 1], vertices[vertex_index + 2], vertices[vertex_index + 3]);
+            for (int tile_x = triangle->min_x / tile_size; tile_x <= (triangle->max_x - 1) / tile_size; tile_x++)
+            {
+                cursors[tile_y * tiles_x + tile_x]++;
+            }
         }
+    }
+
+    float_safe_index_t total = 0;
+    for (int t = 0; t < tiles_count; t++)
+    {
+        bin_offsets[t] = total;
+        total += cursors[t];
+        cursors[t] = bin_offsets[t];
+    }
+    bin_offsets[tiles_count] = total;
+
+    float_safe_index_t *bins = SGL_FrameArenaAlloc(arena, sizeof(float_safe_index_t) * total);
+
+    for (float_safe_index_t i = 0; i < setups_count; i++)
+    {
+        const triangle_setup *triangle = &setups[i];
 
-        printf("\n\n");
+        for (int tile_y = triangle->min_y / tile_size; tile_y <= (triangle->max_y - 1) / tile_size; tile_y++)
+        {
+            for (int tile_x = triangle->min_x / tile_size; tile_x <= (triangle->max_x - 1) / tile_size; tile_x++)
+            {
+                bins[cursors[tile_y * tiles_x + tile_x]++] = i;
+            }
+        }
     }
+
+    *out_bin_offsets = bin_offsets;
+    *out_bins = bins;
 }
 
-bool SGL_Render(SGL_Renderer *renderer, SDL_Event *event) {
-    if (!handle_sdl_events(renderer, event)) {
+// Binned triangles of a frame shared by the workers drawing the tiles
+typedef struct {
+    const triangle_setup *setups;
+    raster_row_function raster_row;
+    const float_safe_index_t *bin_offsets;
+    const float_safe_index_t *bins;
+    int tile_size, tiles_x, tiles_count;
+    uint32_t *pixels;
+    int pitch;
+    float *depth_buffer;
+    int width, height;
+    SDL_AtomicInt next_tile;
+    raster_counters *counters; // One per worker, summed once they all finished
+} tile_job;
+
+/**
+ * Worker side of the binned rasterization: takes the next tile not drawn yet until there are none left and draws its
+ * whole bin. A tile is only drawn by the worker that took it so no pixel is ever written by two threads and each
+ * pixel sees its triangles in the same order whatever the amount of workers, the image doesn't depend on it.
+ */
+static void rasterize_tiles(void *data, int worker_index) {
+    tile_job *job = (tile_job*)data;
+    raster_counters counters = {0};
+
+    for (;;)
+    {
+        int tile = SDL_AddAtomicInt(&job->next_tile, 1);
+        if (tile >= job->tiles_count) {
+            break;
+        }
+
+        int min_x = (tile % job->tiles_x) * job->tile_size;
+        int min_y = (tile / job->tiles_x) * job->tile_size;
+        int max_x = MIN(min_x + job->tile_size, job->width);
+        int max_y = MIN(min_y + job->tile_size, job->height);
+
+        for (float_safe_index_t j = job->bin_offsets[tile]; j < job->bin_offsets[tile + 1]; j++)
+        {
+            rasterize_triangle(&job->setups[job->bins[j]], job->raster_row, min_x, min_y, max_x, max_y, job->pixels, job->pitch, job->depth_buffer, job->width, &counters);
+        }
+    }
+
+    job->counters[worker_index] = counters;
+}
+
+/**
+ * \returns The pool drawing the tiles, created on the first call, or NULL to draw them on the calling thread only.
+ */
+static SGL_ThreadPool* get_thread_pool(SGL_Renderer *renderer) {
+    if (renderer->thread_pool) {
+        return renderer->thread_pool;
+    }
+
+    int threads_count = renderer->threads_count > 0 ? renderer->threads_count : MIN(SDL_GetNumLogicalCPUCores(), MAX_THREADS_COUNT);
+    if (threads_count <= 1) {
+        return NULL;
+    }
+
+    renderer->thread_pool = SGL_CreateThreadPool(threads_count);
+    if (!renderer->thread_pool) {
+        renderer->threads_count = 1; // Don't try again every frame
+    }
+
+    return renderer->thread_pool;
+}
+
+/**
+ * Draws the screen space triangles in the pixels and depth buffers.
+ * \param stats Receives the amount of triangles rasterized and pixels tested, passing the depth test and written (can be NULL).
+ * \returns false if the texture couldn't be locked.
+ */
+static bool render_triangles(SGL_Renderer *renderer, SGL_PipelineStats *stats, const float vertices[], float_safe_index_t triangles[], float_safe_index_t triangles_size) {
+    void *pixels;
+    int pitch;
+
+    if (renderer->is_offscreen) {
+        pixels = renderer->pixels;
+        pitch = renderer->width * (int)sizeof(uint32_t);
+    } else if (!SDL_LockTexture(renderer->texture, NULL, &pixels, &pitch)) {
+        SDL_Log("Failed to lock texture: %s\n", SDL_GetError());
+        free_sdl(renderer);
         return false;
     }
 
-    if (renderer->scene->meshes->size == 0) {
-        return true; // Skip pipeline
+    //IMPORTANT: ARGB format, use pitch instead of SDL renderer width for getting the index of the pixel in the buffer.
+    uint32_t *buffer = (uint32_t *)pixels;
+    int pitch_pixels = pitch / (int)sizeof(uint32_t);
+    float *depth_buffer = renderer->depth_buffer;
+    int width = renderer->width;
+    int height = renderer->height;
+    int tile_size = renderer->tile_size;
+    float_safe_index_t triangles_count = triangles_size / TRIANGLE_ARRAY_SIZE;
+    raster_row_function raster_row = get_raster_row_function(renderer->raster_path);
+    float_safe_index_t setups_count = 0; // Triangles left once the ones drawing nothing are dropped by setup_triangle
+    raster_counters counters = {0};
+
+    clear_rect(buffer, pitch_pixels, depth_buffer, width, 0, 0, width, height);
+
+    if (tile_size == 0) {
+        for (float_safe_index_t i = 0; i < triangles_count; i++) {
+            float_safe_index_t triangle_index = i * TRIANGLE_ARRAY_SIZE;
+
+            const float *v1 = &vertices[(size_t)triangles[triangle_index] * VERTEX_ARRAY_SIZE];
+            const float *v2 = &vertices[(size_t)triangles[triangle_index + 1] * VERTEX_ARRAY_SIZE];
+            const float *v3 = &vertices[(size_t)triangles[triangle_index + 2] * VERTEX_ARRAY_SIZE];
+
+            triangle_setup triangle;
+            if (setup_triangle(v1, v2, v3, triangles[triangle_index + 3], width, height, &triangle)) {
+                setups_count++;
+                rasterize_triangle(&triangle, raster_row, 0, 0, width, height, buffer, pitch_pixels, depth_buffer, width, &counters);
+            }
+        }
+    } else {
+        // Set up every triangle once, then draw tile by tile so the tile's pixels and depth stay in cache
+        triangle_setup *setups = SGL_FrameArenaAlloc(renderer->frame_arena, sizeof(triangle_setup) * triangles_count);
+
+        for (float_safe_index_t i = 0; i < triangles_count; i++) {
+            float_safe_index_t triangle_index = i * TRIANGLE_ARRAY_SIZE;
+
+            const float *v1 = &vertices[(size_t)triangles[triangle_index] * VERTEX_ARRAY_SIZE];
+            const float *v2 = &vertices[(size_t)triangles[triangle_index + 1] * VERTEX_ARRAY_SIZE];
+            const float *v3 = &vertices[(size_t)triangles[triangle_index + 2] * VERTEX_ARRAY_SIZE];
+
+            if (setup_triangle(v1, v2, v3, triangles[triangle_index + 3], width, height, &setups[setups_count])) {
+                setups_count++;
+            }
+        }
+
+        int tiles_x = (width + tile_size - 1) / tile_size;
+        int tiles_y = (height + tile_size - 1) / tile_size;
+        float_safe_index_t *bin_offsets, *bins;
+        bin_triangles(renderer->frame_arena, setups, setups_count, tile_size, tiles_x, tiles_y, &bin_offsets, &bins);
+
+        SGL_ThreadPool *pool = get_thread_pool(renderer);
+        int workers_count = pool ? SGL_ThreadPoolGetWorkersCount(pool) : 1;
+
+        tile_job job = {
+            .setups = setups,
+            .raster_row = raster_row,
+            .bin_offsets = bin_offsets,
+            .bins = bins,
+            .tile_size = tile_size,
+            .tiles_x = tiles_x,
+            .tiles_count = tiles_x * tiles_y,
+            .pixels = buffer,
+            .pitch = pitch_pixels,
+            .depth_buffer = depth_buffer,
+            .width = width,
+            .height = height,
+            .counters = SGL_FrameArenaAlloc(renderer->frame_arena, sizeof(raster_counters) * workers_count)
+        };
+        SDL_SetAtomicInt(&job.next_tile, 0);
+
+        if (pool) {
+            SGL_ThreadPoolRun(pool, rasterize_tiles, &job);
+        } else {
+            rasterize_tiles(&job, 0);
+        }
+
+        for (int i = 0; i < workers_count; i++)
+        {
+            counters.pixels_tested += job.counters[i].pixels_tested;
+            counters.depth_passed += job.counters[i].depth_passed;
+            counters.depth_failed += job.counters[i].depth_failed;
+        }
     }
 
-    // Convert scene into flat arrays for vertices and triangles and local space -> world space
-    float *vertices, *triangles;
-    float_safe_index_t vertices_size, triangles_size;
-    convert_scene_to_flat_arrays(renderer->scene->meshes, &vertices, &vertices_size, &triangles, &triangles_size);
+    if (stats != NULL) {
+        stats->triangles_rasterized = setups_count;
+        stats->pixels_tested = counters.pixels_tested;
+        stats->depth_passed = counters.depth_passed;
+        stats->depth_failed = counters.depth_failed;
+        stats->pixels_written = counters.depth_passed; // No blending or masking, every pixel passing the depth test is written
+    }
+
+    if (!renderer->is_offscreen) {
+        SDL_UnlockTexture(renderer->texture);
+    }
+
+    return true;
+}
 
-    // World space -> View space
-    float view_matrix[16];
-    create_view_matrix(renderer->scene->currentCamera, view_matrix);
-    multiply_matrix_with_vertices(view_matrix, vertices, vertices_size);
 
-    // TODO : Fix culling
-    // Cull backface triangles
-    float *culled_vertices, *culled_triangles;
-    float_safe_index_t culled_vertices_size, culled_triangles_size;
-    cull(vertices, vertices_size, triangles, triangles_size, &culled_vertices, &culled_vertices_size, &culled_triangles, &culled_triangles_size);
+/**
+ * Checks if the scene changed since the last frame: meshes or instances added, removed or modified with their setters
+ * and camera moved. The lists are edited directly by the user so they are compared with the ones drawn last frame.
+ */
+static bool scene_changed(SGL_Renderer *renderer) {
+    SGL_Scene *scene = renderer->scene;
+    SGL_List *meshes = scene->meshes;
+    SGL_List *instances = scene->instances;
 
-    stage_debug_print("View space: After culling", culled_vertices_size, culled_triangles_size, culled_vertices, culled_triangles);
+    if (!renderer->view_projection_valid || !camera_equals(&renderer->view_projection_camera, scene->currentCamera)) {
+        return true;
+    }
 
-    // Free world space data (the moment you don't need it anymore, don't wait and forget)
-    free_pipeline_step(vertices, triangles);
+    if (meshes->size != renderer->drawn_meshes_count || instances->size != renderer->drawn_instances_count) {
+        return true;
+    }
 
-    // View space -> Clip space
-    float projection_matrix[16];
-    create_projection_matrix(renderer, renderer->scene->currentCamera, projection_matrix);
-    multiply_matrix_with_vertices(projection_matrix, culled_vertices, culled_vertices_size);
+    // Nothing drawn is not even allocated after an empty scene, the counts above are enough then
+    if (meshes->size + instances->size > 0 &&
+        (memcmp(renderer->drawn_items, meshes->items, sizeof(void*) * meshes->size) != 0 ||
+         memcmp(renderer->drawn_items + meshes->size, instances->items, sizeof(void*) * instances->size) != 0)) {
+        return true;
+    }
+
+    for (float_safe_index_t i = 0; i < meshes->size; i++)
+    {
+        if (((SGL_Mesh*)meshes->items[i])->changed) return true;
+    }
+
+    for (float_safe_index_t i = 0; i < instances->size; i++)
+    {
+        // The shared mesh's setters (SGL_MeshSetPositions...) only flag the mesh, which may be drawn only through instances
+        SGL_MeshInstance *instance = (SGL_MeshInstance*)instances->items[i];
+        if (instance->changed || instance->mesh->changed) return true;
+    }
+
+    return false;
+}
 
-    // Clip triangles
-    float *clipped_vertices, *clipped_triangles;
-    float_safe_index_t clipped_vertices_size, clipped_triangles_size;
-    clip(culled_vertices, culled_vertices_size, culled_triangles, culled_triangles_size, &clipped_vertices, &clipped_vertices_size, &clipped_triangles, &clipped_triangles_size);
+/**
+ * Keeps the meshes and instances of the frame that was just drawn for scene_changed.
+ */
+static void remember_drawn_items(SGL_Renderer *renderer) {
+    SGL_List *meshes = renderer->scene->meshes;
+    SGL_List *instances = renderer->scene->instances;
+    size_t count = (size_t)meshes->size + instances->size;
+
+    if (count > renderer->drawn_items_capacity) {
+        renderer->drawn_items = realloc(renderer->drawn_items, sizeof(void*) * count);
+        renderer->drawn_items_capacity = count;
+    }
 
-    // Free view space data
-    free_pipeline_step(culled_vertices, culled_triangles);
+    if (count > 0) {
+        memcpy(renderer->drawn_items, meshes->items, sizeof(void*) * meshes->size);
+        memcpy(renderer->drawn_items + meshes->size, instances->items, sizeof(void*) * instances->size);
+    }
 
-    // Clip space -> NDC space
-    apply_perspective_division_clip_vertices(clipped_vertices, clipped_vertices_size);
+    renderer->drawn_meshes_count = meshes->size;
+    renderer->drawn_instances_count = instances->size;
+}
 
-    // NDC space -> Screen space
-    map_ndc_vertices_to_screen_coordinates(renderer, clipped_vertices, clipped_vertices_size);
+/**
+ * Shows the texture in the window (nothing to do for offscreen renderers).
+ */
+static void present_frame(SGL_Renderer *renderer) {
+    if (!renderer->is_offscreen) {
+        SDL_RenderTexture(renderer->sdl_renderer, renderer->texture, NULL, NULL);
+        SDL_RenderPresent(renderer->sdl_renderer);
+    }
+}
+
+bool SGL_ProcessEvent(SGL_Renderer *renderer, SDL_Event *event) {
+    return handle_sdl_events(renderer, event);
+}
+
+void SGL_RenderFrame(SGL_Renderer *renderer) {
+    // Nothing moved, the texture still holds the last frame
+    renderer->presented = false;
+
+    if (!renderer->needs_redraw && !scene_changed(renderer)) {
+        if (renderer->needs_present) {
+            present_frame(renderer);
+            renderer->needs_present = false;
+            renderer->presented = true;
+        }
+
+        FRAME_STATS_SKIPPED(renderer);
+        return;
+    }
+
+    FRAME_STATS_BEGIN(renderer);
+
+    // World space -> View space -> Clip space, composed once so the vertices only go through one matrix
+    update_view_projection_matrix(renderer);
+    float *view_projection_matrix = renderer->view_projection_matrix;
+
+    // Screen space output of the geometry stages, none for an empty scene: only the buffers are cleared so the
+    // meshes that were just removed don't stay on screen
+    float *screen_vertices = NULL;
+    float_safe_index_t *screen_triangles = NULL;
+    float_safe_index_t screen_vertices_size = 0, screen_triangles_size = 0;
+
+    if (renderer->scene->meshes->size > 0 || renderer->scene->instances->size > 0) {
+        // Convert scene into flat arrays for vertices and triangles and local space -> clip space
+        float *vertices;
+        float_safe_index_t *triangles;
+        float_safe_index_t vertices_size, triangles_size;
+        convert_scene_to_flat_arrays(renderer->frame_arena, renderer->scene, view_projection_matrix, &vertices, &vertices_size, &triangles, &triangles_size);
+        FRAME_STATS_STAGE(renderer, SGL_STAGE_FLATTEN);
+
+        SGL_PipelineStats *pipeline_stats = PIPELINE_STATS(renderer);
+        if (pipeline_stats != NULL) {
+            pipeline_stats->vertices_in = vertices_size / VERTEX_ARRAY_SIZE;
+            pipeline_stats->triangles_in = triangles_size / TRIANGLE_ARRAY_SIZE;
+        }
+
+        // Cull backface triangles
+        float *culled_vertices;
+        float_safe_index_t *culled_triangles;
+        float_safe_index_t culled_vertices_size, culled_triangles_size;
+        cull(renderer->vertices_index_map, renderer->frame_arena, PIPELINE_STATS(renderer), vertices, vertices_size, triangles, triangles_size, &culled_vertices, &culled_vertices_size, &culled_triangles, &culled_triangles_size);
+        FRAME_STATS_STAGE(renderer, SGL_STAGE_CULL);
+
+        // Clip triangles
+        clip(renderer->vertices_index_map, renderer->frame_arena, PIPELINE_STATS(renderer), culled_vertices, culled_vertices_size, culled_triangles, culled_triangles_size, &screen_vertices, &screen_vertices_size, &screen_triangles, &screen_triangles_size);
+        FRAME_STATS_STAGE(renderer, SGL_STAGE_CLIP);
+
+        // Clip space -> NDC space
+        apply_perspective_division_clip_vertices(screen_vertices, screen_vertices_size);
+        FRAME_STATS_STAGE(renderer, SGL_STAGE_DIVIDE);
+
+        // NDC space -> Screen space
+        map_ndc_vertices_to_screen_coordinates(renderer, screen_vertices, screen_vertices_size);
+        FRAME_STATS_STAGE(renderer, SGL_STAGE_VIEWPORT);
+    }
 
     // Rasterization
-    render_triangles(renderer, clipped_vertices, clipped_vertices_size, clipped_triangles, clipped_triangles_size);
+    if (!render_triangles(renderer, PIPELINE_STATS(renderer), screen_vertices, screen_triangles, screen_triangles_size)) {
+        return; // SDL was freed, nothing left to present to
+    }
+    FRAME_STATS_STAGE(renderer, SGL_STAGE_RASTER);
+
+    present_frame(renderer);
+    renderer->presented = true;
+    FRAME_STATS_STAGE(renderer, SGL_STAGE_PRESENT);
+
+    // Release every stage output at once, memory is kept for the next frame
+    SGL_FrameArenaReset(renderer->frame_arena);
 
-    // Free screen space data
-    free_pipeline_step(clipped_vertices, clipped_triangles);
+    remember_drawn_items(renderer);
+    renderer->needs_redraw = false;
+    renderer->needs_present = false;
+
+    FRAME_STATS_END(renderer);
+}
 
+bool SGL_Render(SGL_Renderer *renderer, SDL_Event *event) {
+    if (!SGL_ProcessEvent(renderer, event)) {
+        return false;
+    }
+
+    SGL_RenderFrame(renderer);
     return true;
+}
+
+void SGL_Run(SGL_Renderer *renderer, const SGL_FramePacing *pacing) {
+    if (!renderer->is_offscreen) {
+        SDL_SetRenderVSync(renderer->sdl_renderer, pacing->vsync ? 1 : SDL_RENDERER_VSYNC_DISABLED);
+    }
+
+    float update_rate = pacing->update_rate > 0 ? pacing->update_rate : DEFAULT_UPDATE_RATE;
+    Uint64 update_step = (Uint64)(SDL_NS_PER_SECOND / update_rate);
+    float update_step_seconds = 1.0f / update_rate;
+    Uint64 frame_duration = pacing->target_fps > 0 ? SDL_NS_PER_SECOND / pacing->target_fps : 0;
+
+    Uint64 previous_time = SDL_GetTicksNS();
+    Uint64 next_frame_time = previous_time;
+    Uint64 accumulated_time = 0;
+
+    while (true) {
+        SDL_Event event;
+        while (SDL_PollEvent(&event)) {
+            if (!SGL_ProcessEvent(renderer, &event)) {
+                return;
+            }
+            if (pacing->event != NULL && !pacing->event(renderer, &event, pacing->user_data)) {
+                return;
+            }
+        }
+
+        // Fixed timestep: run as many updates as the time that passed allows, the rest carries over to the next frame
+        Uint64 now = SDL_GetTicksNS();
+        accumulated_time += now - previous_time;
+        previous_time = now;
+
+        // After a long stall (window dragged, debugger) drop the time instead of running hundreds of updates
+        if (accumulated_time > update_step * MAX_UPDATES_PER_FRAME) {
+            accumulated_time = update_step * MAX_UPDATES_PER_FRAME;
+        }
+
+        while (accumulated_time >= update_step) {
+            if (pacing->update != NULL) {
+                pacing->update(renderer, update_step_seconds, pacing->user_data);
+            }
+            accumulated_time -= update_step;
+        }
+
+        SGL_RenderFrame(renderer);
+
+        // Sleep until the next frame is due, frames are scheduled from the previous due time so the rate doesn't drift
+        if (frame_duration > 0) {
+            next_frame_time += frame_duration;
+            now = SDL_GetTicksNS();
+
+            if (now < next_frame_time) {
+                SDL_DelayPrecise(next_frame_time - now);
+            } else {
+                next_frame_time = now; // Running late, don't try to catch up
+            }
+        } else if (!renderer->presented) {
+            // Nothing changed so nothing waited for vsync either: sleep until the next update instead of spinning
+            Uint64 elapsed = accumulated_time + (SDL_GetTicksNS() - previous_time);
+            if (elapsed < update_step) {
+                SDL_DelayNS(update_step - elapsed);
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "SGL_Buffer.h"
+#define INITIAL_BUFFER_CAPACITY 16
+
+SGL_FloatBuffer* SGL_CreateFloatBufferInArena(SGL_FrameArena *arena, float_safe_index_t capacity) {
+    SGL_FloatBuffer *buffer = SGL_FrameArenaAlloc(arena, sizeof(SGL_FloatBuffer));
+    buffer->size = 0;
+    buffer->capacity = capacity > 0 ? capacity : INITIAL_BUFFER_CAPACITY;
+    buffer->items = SGL_FrameArenaAlloc(arena, sizeof(float) * buffer->capacity);
+    buffer->arena = arena;
+    return buffer;
+}
+
+void SGL_FloatBufferReserve(SGL_FloatBuffer *buffer, float_safe_index_t capacity) {
+    if (capacity <= buffer->capacity) return;
+
+    float_safe_index_t new_capacity = buffer->capacity;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    buffer->items = SGL_FrameArenaGrow(buffer->arena, buffer->items, sizeof(float) * buffer->size, sizeof(float) * new_capacity);
+    buffer->capacity = new_capacity;
+}
+
+void SGL_FloatBufferAddArray(SGL_FloatBuffer *buffer, const float *values, float_safe_index_t count) {
+    SGL_FloatBufferReserve(buffer, buffer->size + count);
+    memcpy(buffer->items + buffer->size, values, sizeof(float) * count);
+    buffer->size += count;
+}
+
+void SGL_FloatBufferClear(SGL_FloatBuffer *buffer) {
+    buffer->size = 0;
+}
+
+SGL_IndexBuffer* SGL_CreateIndexBufferInArena(SGL_FrameArena *arena, float_safe_index_t capacity) {
+    SGL_IndexBuffer *buffer = SGL_FrameArenaAlloc(arena, sizeof(SGL_IndexBuffer));
+    buffer->size = 0;
+    buffer->capacity = capacity > 0 ? capacity : INITIAL_BUFFER_CAPACITY;
+    buffer->items = SGL_FrameArenaAlloc(arena, sizeof(float_safe_index_t) * buffer->capacity);
+    buffer->arena = arena;
+    return buffer;
+}
+
+void SGL_IndexBufferReserve(SGL_IndexBuffer *buffer, float_safe_index_t capacity) {
+    if (capacity <= buffer->capacity) return;
+
+    float_safe_index_t new_capacity = buffer->capacity;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+
+    buffer->items = SGL_FrameArenaGrow(buffer->arena, buffer->items, sizeof(float_safe_index_t) * buffer->size, sizeof(float_safe_index_t) * new_capacity);
+    buffer->capacity = new_capacity;
+}
+
+void SGL_IndexBufferAddArray(SGL_IndexBuffer *buffer, const float_safe_index_t *values, float_safe_index_t count) {
+    SGL_IndexBufferReserve(buffer, buffer->size + count);
+    memcpy(buffer->items + buffer->size, values, sizeof(float_safe_index_t) * count);
+    buffer->size += count;
+}
+
+void SGL_IndexBufferClear(SGL_IndexBuffer *buffer) {
+    buffer->size = 0;
+}
@@ -0,0 +1,105 @@
+#include "SGL_FrameArena.h"
+#define INITIAL_FRAME_ARENA_CAPACITY 65536
+
+// Overflow blocks start with this header, data starts right after it (stays aligned)
+typedef union overflow_header {
+    union overflow_header *next;
+    unsigned char padding[SGL_FRAME_ARENA_ALIGNMENT];
+} overflow_header;
+
+static size_t align_size(size_t size) {
+    return (size + SGL_FRAME_ARENA_ALIGNMENT - 1) & ~(size_t)(SGL_FRAME_ARENA_ALIGNMENT - 1);
+}
+
+SGL_FrameArena* SGL_CreateFrameArena(size_t capacity) {
+    SGL_FrameArena *arena = malloc(sizeof(SGL_FrameArena));
+    arena->capacity = align_size(capacity > 0 ? capacity : INITIAL_FRAME_ARENA_CAPACITY);
+    arena->base = SDL_aligned_alloc(SGL_FRAME_ARENA_ALIGNMENT, arena->capacity);
+    arena->offset = 0;
+    arena->last_allocation = NULL;
+    arena->overflow_blocks = NULL;
+    arena->overflow_size = 0;
+    arena->high_water_mark = 0;
+    return arena;
+}
+
+void* SGL_FrameArenaAlloc(SGL_FrameArena *arena, size_t size) {
+    size = align_size(size);
+
+    if (arena->offset + size <= arena->capacity) {
+        void *allocation = arena->base + arena->offset;
+        arena->offset += size;
+        arena->last_allocation = allocation;
+        return allocation;
+    }
+
+    // Doesn't fit for this frame, keep it aside until the next reset
+    overflow_header *block = SDL_aligned_alloc(SGL_FRAME_ARENA_ALIGNMENT, sizeof(overflow_header) + size);
+    if (!block) return NULL;
+
+    block->next = arena->overflow_blocks;
+    arena->overflow_blocks = block;
+    arena->overflow_size += size;
+    arena->last_allocation = NULL;
+
+    return block + 1;
+}
+
+void* SGL_FrameArenaGrow(SGL_FrameArena *arena, void *allocation, size_t old_size, size_t new_size) {
+    if (allocation != NULL && allocation == arena->last_allocation) {
+        size_t start = (unsigned char *)allocation - arena->base;
+        if (start + align_size(new_size) <= arena->capacity) {
+            arena->offset = start + align_size(new_size);
+            return allocation;
+        }
+    }
+
+    void *new_allocation = SGL_FrameArenaAlloc(arena, new_size);
+    if (new_allocation && allocation) {
+        memcpy(new_allocation, allocation, old_size < new_size ? old_size : new_size);
+    }
+
+    return new_allocation;
+}
+
+static void free_overflow_blocks(SGL_FrameArena *arena) {
+    overflow_header *block = arena->overflow_blocks;
+    while (block != NULL) {
+        overflow_header *next = block->next;
+        SDL_aligned_free(block);
+        block = next;
+    }
+    arena->overflow_blocks = NULL;
+    arena->overflow_size = 0;
+}
+
+void SGL_FrameArenaReset(SGL_FrameArena *arena) {
+    size_t used = arena->offset + arena->overflow_size;
+    if (used > arena->high_water_mark) {
+        arena->high_water_mark = used;
+    }
+
+    if (arena->overflow_blocks != NULL) {
+        free_overflow_blocks(arena);
+
+        // Regrow so the biggest frame seen so far fits in one block, with some headroom so a scene
+        // that slowly gets bigger doesn't regrow every frame
+        SDL_aligned_free(arena->base);
+        arena->capacity = align_size(arena->high_water_mark + arena->high_water_mark / 2);
+        arena->base = SDL_aligned_alloc(SGL_FRAME_ARENA_ALIGNMENT, arena->capacity);
+    }
+
+    arena->offset = 0;
+    arena->last_allocation = NULL;
+}
+
+size_t SGL_FrameArenaGetHighWaterMark(SGL_FrameArena *arena) {
+    size_t used = arena->offset + arena->overflow_size;
+    return used > arena->high_water_mark ? used : arena->high_water_mark;
+}
+
+void SGL_FreeFrameArena(SGL_FrameArena *arena) {
+    free_overflow_blocks(arena);
+    SDL_aligned_free(arena->base);
+    free(arena);
+}
@@ -0,0 +1,147 @@
+#include "SGL_IndexMap.h"
+#define INITIAL_INDEX_MAP_CAPACITY 16
+
+// Capacity is always a power of 2 so the slot can be found with a mask instead of a modulo
+static float_safe_index_t slot_of(SGL_IndexMap *map, float_safe_index_t key) {
+    // Fibonacci hashing, keys are often multiples of the same stride so they need to be spread
+    float_safe_index_t hash = key * 2654435769u;
+    hash ^= hash >> 16;
+    return hash & (map->capacity - 1);
+}
+
+static void fill_empty(SGL_IndexMapEntry *entries, float_safe_index_t capacity) {
+    // Every byte of the empty key is 0xFF
+    memset(entries, 0xFF, sizeof(SGL_IndexMapEntry) * capacity);
+}
+
+SGL_IndexMap* SGL_CreateIndexMap(float_safe_index_t capacity) {
+    SGL_IndexMap *map = malloc(sizeof(SGL_IndexMap));
+    map->capacity = INITIAL_INDEX_MAP_CAPACITY;
+    map->size = 0;
+
+    while (map->capacity * 3 < capacity * 4) { // Max load factor of 0.75
+        map->capacity *= 2;
+    }
+
+    map->entries = malloc(sizeof(SGL_IndexMapEntry) * map->capacity);
+    fill_empty(map->entries, map->capacity);
+    return map;
+}
+
+static void resize(SGL_IndexMap *map, float_safe_index_t new_capacity) {
+    SGL_IndexMapEntry *old_entries = map->entries;
+    float_safe_index_t old_capacity = map->capacity;
+
+    map->entries = malloc(sizeof(SGL_IndexMapEntry) * new_capacity);
+    map->capacity = new_capacity;
+    map->size = 0; // Will be recomputed as we re-insert
+    fill_empty(map->entries, new_capacity);
+
+    for (float_safe_index_t i = 0; i < old_capacity; i++) {
+        if (old_entries[i].key != SGL_INDEX_MAP_EMPTY_KEY) {
+            SGL_IndexMapPut(map, old_entries[i].key, old_entries[i].value);
+        }
+    }
+
+    free(old_entries);
+}
+
+void SGL_IndexMapReserve(SGL_IndexMap *map, float_safe_index_t count) {
+    float_safe_index_t new_capacity = map->capacity;
+    while (new_capacity * 3 < count * 4) {
+        new_capacity *= 2;
+    }
+
+    if (new_capacity != map->capacity) {
+        resize(map, new_capacity);
+    }
+}
+
+void SGL_IndexMapPut(SGL_IndexMap *map, float_safe_index_t key, float_safe_index_t value) {
+    if ((map->size + 1) * 4 > map->capacity * 3) { // update capacity
+        resize(map, map->capacity * 2);
+    }
+
+    float_safe_index_t mask = map->capacity - 1;
+    float_safe_index_t slot = slot_of(map, key);
+
+    while (map->entries[slot].key != SGL_INDEX_MAP_EMPTY_KEY) {
+        if (map->entries[slot].key == key) {
+            map->entries[slot].value = value; // update existing
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // Key not found
+    map->entries[slot].key = key;
+    map->entries[slot].value = value;
+    map->size++;
+}
+
+bool SGL_IndexMapGet(SGL_IndexMap *map, float_safe_index_t key, float_safe_index_t *out_value) {
+    float_safe_index_t mask = map->capacity - 1;
+    float_safe_index_t slot = slot_of(map, key);
+
+    while (map->entries[slot].key != SGL_INDEX_MAP_EMPTY_KEY) {
+        if (map->entries[slot].key == key) {
+            *out_value = map->entries[slot].value;
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return false;
+}
+
+void SGL_IndexMapRemove(SGL_IndexMap *map, float_safe_index_t key) {
+    float_safe_index_t mask = map->capacity - 1;
+    float_safe_index_t slot = slot_of(map, key);
+
+    while (map->entries[slot].key != key) {
+        if (map->entries[slot].key == SGL_INDEX_MAP_EMPTY_KEY) return;
+        slot = (slot + 1) & mask;
+    }
+
+    // Backward shift deletion: move back the following entries of the cluster so lookups never stop on a hole
+    float_safe_index_t hole = slot;
+    float_safe_index_t next = (hole + 1) & mask;
+
+    while (map->entries[next].key != SGL_INDEX_MAP_EMPTY_KEY) {
+        float_safe_index_t home = slot_of(map, map->entries[next].key);
+
+        // Entry can fill the hole only if its home slot isn't between the hole and itself (cyclically)
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            map->entries[hole] = map->entries[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    map->entries[hole].key = SGL_INDEX_MAP_EMPTY_KEY;
+    map->size--;
+}
+
+void SGL_IndexMapClear(SGL_IndexMap *map) {
+    if (map->size == 0) return;
+    fill_empty(map->entries, map->capacity);
+    map->size = 0;
+}
+
+bool SGL_IndexMapNext(SGL_IndexMap *map, float_safe_index_t *iterator, float_safe_index_t *out_key, float_safe_index_t *out_value) {
+    while (*iterator < map->capacity) {
+        SGL_IndexMapEntry *entry = &map->entries[(*iterator)++];
+        if (entry->key != SGL_INDEX_MAP_EMPTY_KEY) {
+            *out_key = entry->key;
+            *out_value = entry->value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SGL_FreeIndexMap(SGL_IndexMap *map) {
+    free(map->entries);
+    free(map);
+}
@@ -0,0 +1,106 @@
+#include "SGL_ThreadPool.h"
+#include <stdio.h>
+
+struct SGL_ThreadPoolWorker {
+    SGL_ThreadPool *pool;
+    int index;
+    SDL_Thread *thread;
+    SDL_Semaphore *start; // One per thread so each one runs a job exactly once per run
+};
+
+static int SDLCALL worker_loop(void *data) {
+    SGL_ThreadPoolWorker *worker = (SGL_ThreadPoolWorker*)data;
+    SGL_ThreadPool *pool = worker->pool;
+
+    for (;;)
+    {
+        SDL_WaitSemaphore(worker->start);
+
+        // The semaphores order the accesses, job and quit are written before start is signaled
+        if (pool->quit) {
+            return 0;
+        }
+
+        pool->job(pool->job_data, worker->index);
+        SDL_SignalSemaphore(pool->done);
+    }
+}
+
+SGL_ThreadPool* SGL_CreateThreadPool(int workers_count) {
+    SGL_ThreadPool *pool = malloc(sizeof(SGL_ThreadPool));
+    pool->workers_count = workers_count > 1 ? workers_count : 1;
+    pool->workers = calloc(pool->workers_count, sizeof(SGL_ThreadPoolWorker));
+    pool->done = SDL_CreateSemaphore(0);
+    pool->job = NULL;
+    pool->job_data = NULL;
+    pool->quit = false;
+
+    if (!pool->done) {
+        SDL_Log("Thread pool semaphore creation failed: %s\n", SDL_GetError());
+        pool->workers_count = 1;
+        SGL_FreeThreadPool(pool);
+        return NULL;
+    }
+
+    for (int i = 1; i < pool->workers_count; i++)
+    {
+        SGL_ThreadPoolWorker *worker = &pool->workers[i];
+        char name[32];
+        snprintf(name, sizeof(name), "SGL worker %d", i);
+
+        worker->pool = pool;
+        worker->index = i;
+        worker->start = SDL_CreateSemaphore(0);
+        worker->thread = worker->start ? SDL_CreateThread(worker_loop, name, worker) : NULL;
+
+        if (!worker->thread) {
+            SDL_Log("Thread pool worker creation failed: %s\n", SDL_GetError());
+            SDL_DestroySemaphore(worker->start);
+            pool->workers_count = i; // Only stop the threads started so far
+            SGL_FreeThreadPool(pool);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+void SGL_ThreadPoolRun(SGL_ThreadPool *pool, SGL_ThreadPoolJob job, void *data) {
+    pool->job = job;
+    pool->job_data = data;
+
+    for (int i = 1; i < pool->workers_count; i++)
+    {
+        SDL_SignalSemaphore(pool->workers[i].start);
+    }
+
+    job(data, 0);
+
+    for (int i = 1; i < pool->workers_count; i++)
+    {
+        SDL_WaitSemaphore(pool->done);
+    }
+}
+
+int SGL_ThreadPoolGetWorkersCount(SGL_ThreadPool *pool) {
+    return pool->workers_count;
+}
+
+void SGL_FreeThreadPool(SGL_ThreadPool *pool) {
+    pool->quit = true;
+
+    for (int i = 1; i < pool->workers_count; i++)
+    {
+        SDL_SignalSemaphore(pool->workers[i].start);
+    }
+
+    for (int i = 1; i < pool->workers_count; i++)
+    {
+        SDL_WaitThread(pool->workers[i].thread, NULL);
+        SDL_DestroySemaphore(pool->workers[i].start);
+    }
+
+    SDL_DestroySemaphore(pool->done);
+    free(pool->workers);
+    free(pool);
+}
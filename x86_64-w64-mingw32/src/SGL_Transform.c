@@ -0,0 +1,135 @@
+#include "SGL_Transform.h"
+
+typedef void (*transform_function)(const float m[16], const float *in, float *out, float_safe_index_t count);
+
+void SGL_TransformVerticesScalar(const float m[16], const float *in, float *out, float_safe_index_t count) {
+    for (size_t i = 0; i < (size_t)count * 4; i += 4)
+    {
+        float x = in[i];
+        float y = in[i + 1];
+        float z = in[i + 2];
+        float w = in[i + 3];
+
+        out[i] = x * m[0] + y * m[4] + z * m[8] + w * m[12];
+        out[i + 1] = x * m[1] + y * m[5] + z * m[9] + w * m[13];
+        out[i + 2] = x * m[2] + y * m[6] + z * m[10] + w * m[14];
+        out[i + 3] = x * m[3] + y * m[7] + z * m[11] + w * m[15];
+    }
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+/**
+ * A vertex fills a whole register so the result is x * row0 + y * row1 + z * row2 + w * row3
+ * where each component is broadcast with a shuffle.
+ */
+static inline __m128 SDL_TARGETING("sse2") transform_vertex_sse2(__m128 v, __m128 row0, __m128 row1, __m128 row2, __m128 row3) {
+    __m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128 z = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+    __m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m128 result = _mm_add_ps(_mm_mul_ps(x, row0), _mm_mul_ps(y, row1));
+    result = _mm_add_ps(result, _mm_mul_ps(z, row2));
+    return _mm_add_ps(result, _mm_mul_ps(w, row3));
+}
+
+void SDL_TARGETING("sse2") SGL_TransformVerticesSSE2(const float m[16], const float *in, float *out, float_safe_index_t count) {
+    __m128 row0 = _mm_loadu_ps(&m[0]);
+    __m128 row1 = _mm_loadu_ps(&m[4]);
+    __m128 row2 = _mm_loadu_ps(&m[8]);
+    __m128 row3 = _mm_loadu_ps(&m[12]);
+
+    size_t i = 0;
+    size_t end = (size_t)count * 4;
+
+    // 4 independent vertices per iteration so the multiplies of one don't wait on the adds of the other
+    for (; i + 16 <= end; i += 16)
+    {
+        __m128 v0 = _mm_loadu_ps(&in[i]);
+        __m128 v1 = _mm_loadu_ps(&in[i + 4]);
+        __m128 v2 = _mm_loadu_ps(&in[i + 8]);
+        __m128 v3 = _mm_loadu_ps(&in[i + 12]);
+
+        _mm_storeu_ps(&out[i], transform_vertex_sse2(v0, row0, row1, row2, row3));
+        _mm_storeu_ps(&out[i + 4], transform_vertex_sse2(v1, row0, row1, row2, row3));
+        _mm_storeu_ps(&out[i + 8], transform_vertex_sse2(v2, row0, row1, row2, row3));
+        _mm_storeu_ps(&out[i + 12], transform_vertex_sse2(v3, row0, row1, row2, row3));
+    }
+
+    for (; i < end; i += 4)
+    {
+        _mm_storeu_ps(&out[i], transform_vertex_sse2(_mm_loadu_ps(&in[i]), row0, row1, row2, row3));
+    }
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+/**
+ * Same as the SSE2 version with two vertices per register, the rows are duplicated in both 128 bits lanes
+ * so the in-lane permutes broadcast each vertex's components.
+ */
+static inline __m256 SDL_TARGETING("avx2") transform_vertices_avx2(__m256 v, __m256 row0, __m256 row1, __m256 row2, __m256 row3) {
+    __m256 x = _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0));
+    __m256 y = _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1));
+    __m256 z = _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2));
+    __m256 w = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3));
+
+    __m256 result = _mm256_add_ps(_mm256_mul_ps(x, row0), _mm256_mul_ps(y, row1));
+    result = _mm256_add_ps(result, _mm256_mul_ps(z, row2));
+    return _mm256_add_ps(result, _mm256_mul_ps(w, row3));
+}
+
+void SDL_TARGETING("avx2") SGL_TransformVerticesAVX2(const float m[16], const float *in, float *out, float_safe_index_t count) {
+    __m256 row0 = _mm256_broadcast_ps((const __m128*)&m[0]);
+    __m256 row1 = _mm256_broadcast_ps((const __m128*)&m[4]);
+    __m256 row2 = _mm256_broadcast_ps((const __m128*)&m[8]);
+    __m256 row3 = _mm256_broadcast_ps((const __m128*)&m[12]);
+
+    size_t i = 0;
+    size_t end = (size_t)count * 4;
+
+    for (; i + 32 <= end; i += 32)
+    {
+        __m256 v0 = _mm256_loadu_ps(&in[i]);
+        __m256 v1 = _mm256_loadu_ps(&in[i + 8]);
+        __m256 v2 = _mm256_loadu_ps(&in[i + 16]);
+        __m256 v3 = _mm256_loadu_ps(&in[i + 24]);
+
+        _mm256_storeu_ps(&out[i], transform_vertices_avx2(v0, row0, row1, row2, row3));
+        _mm256_storeu_ps(&out[i + 8], transform_vertices_avx2(v1, row0, row1, row2, row3));
+        _mm256_storeu_ps(&out[i + 16], transform_vertices_avx2(v2, row0, row1, row2, row3));
+        _mm256_storeu_ps(&out[i + 24], transform_vertices_avx2(v3, row0, row1, row2, row3));
+    }
+
+    for (; i + 8 <= end; i += 8)
+    {
+        _mm256_storeu_ps(&out[i], transform_vertices_avx2(_mm256_loadu_ps(&in[i]), row0, row1, row2, row3));
+    }
+
+    // Odd vertex left
+    if (i < end) {
+        SGL_TransformVerticesScalar(m, &in[i], &out[i], 1);
+    }
+}
+#endif
+
+static transform_function select_transform_function(void) {
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) return SGL_TransformVerticesAVX2;
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) return SGL_TransformVerticesSSE2;
+#endif
+    return SGL_TransformVerticesScalar;
+}
+
+void SGL_TransformVertices(const float m[16], const float *in, float *out, float_safe_index_t count) {
+    // Every thread would pick the same function so racing on the first call is harmless
+    static transform_function transform = NULL;
+
+    if (transform == NULL) {
+        transform = select_transform_function();
+    }
+
+    transform(m, in, out, count);
+}
@@ -1,6 +1,33 @@
 #include <stdio.h>
 #include "SGL.h"
 
+static const float CAMERA_SPEED = 1.0f; // Units per second
+static const float CAMERA_TURN_SPEED = 45.0f; // Degrees per second
+
+/**
+ * Called at a fixed rate by SGL_Run so movements are the same whatever the frame rate is. Keys are read
+ * from the keyboard state instead of events so holding a key moves smoothly.
+ */
+static void update(SGL_Renderer *renderer, float step, void *user_data) {
+    SGL_Scene *scene = (SGL_Scene*)user_data;
+    const bool *keys = SDL_GetKeyboardState(NULL);
+
+    if (keys[SDL_SCANCODE_W]) {
+        scene->currentCamera->position.z += CAMERA_SPEED * step;
+    }
+    if (keys[SDL_SCANCODE_S]) {
+        scene->currentCamera->position.z -= CAMERA_SPEED * step;
+    }
+    if (keys[SDL_SCANCODE_LEFT]) {
+        scene->currentCamera->orientation.y += CAMERA_TURN_SPEED * step;
+    }
+    if (keys[SDL_SCANCODE_RIGHT]) {
+        scene->currentCamera->orientation.y -= CAMERA_TURN_SPEED * step;
+    }
+
+    // Add other repeating logic here (eg: animal moving)
+}
+
 int main(int argc, char* argv[]) {
     SGL_Scene *scene = SGL_CreateScene(); // Create scene attached to renderer
     SGL_Renderer *renderer = SGL_CreateRenderer("SGL C Demo", scene);
@@ -14,47 +41,18 @@ int main(int argc, char* argv[]) {
     SGL_Mesh *cube = SGL_CreateCubeMesh((SGL_Vector3){0.0f, 0.0f, 3.0f});
     SGL_ListAdd(scene->meshes, cube);
 
-    bool running = true;
-
-    while (running) {
-        SDL_Event event;
-
-        /**
-         * Manually poll events here to be able to read for user inputs, etc. and send event to SGL_Render() first
-         * since it handles the window, if the function returns false, then you know the SDL program stopped
-         * and you should too (depending on what you're doing of course)
-         */
-        while (SDL_PollEvent(&event)) {
-            if (!SGL_Render(renderer, &event)) {
-                running = false;
-                break;
-            }
-            if (event.type == SDL_EVENT_KEY_DOWN) {
-                switch (event.key.key)
-                {
-                case SDLK_W:
-                    scene->currentCamera->position.z += 0.01f;
-                    break;
-                case SDLK_S:
-                    scene->currentCamera->position.z -= 0.01f;
-                    break;
-                case SDLK_LEFT:
-                    scene->currentCamera->orientation.y += 0.01f;
-                    break;
-                case SDLK_RIGHT:
-                    scene->currentCamera->orientation.y -= 0.01f;
-                    break;
-                default:
-                    break;
-                }
-            }
-            // Add other events check here for event logic (eg: character moving based on user input)
-        }
-
-        if (!running) break;
-
-        // Repeating logic (eg: animal moving)
-    }
+    /**
+     * SGL_Run polls the events (the window ones are handled for you), calls update at a fixed rate and renders
+     * one frame per loop, it returns once the window is closed. If you need your own loop, call SGL_ProcessEvent
+     * for every polled event and SGL_RenderFrame once per frame instead.
+     */
+    SGL_FramePacing pacing = {
+        .target_fps = 60,
+        .update_rate = 60.0f,
+        .update = update,
+        .user_data = scene
+    };
+    SGL_Run(renderer, &pacing);
 
     // Don't forget to free your stuff here!
     SGL_FreeRenderer(renderer);